@@ -0,0 +1,763 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Headless benchmark for the generated Heavy_WSTD_DL3Y context.
+
+   Links only the hvcc output (no DPF, no host) and pushes stereo audio through
+   the graph for every sample rate / block size combination, in three cases:
+    - static:     parameters set once, then left alone
+    - automation: all 22 @hv_param receivers get a new value every block
+    - tempo:      all bands synced, __hv_dpf_bpm changes every block
+
+   A second table compares N Heavy contexts against one DL3YBatch processing the same N instances,
+   a third one the native DL3YEngine against the Heavy context it replaces, in speed and output,
+   one the cost and output difference of the engine's Quality entries against Normal, one the engine
+   on mono input with and without its single channel path, and a last one the fixed cost per block at
+   the 32 frame live setting, of Heavy on the host buffers (DL3YVectorBlocks) and of the engine.
+
+   Run with `make bench`, BENCH_SECONDS sets the seconds of audio per run.
+ */
+
+#include "Heavy_WSTD_DL3Y.h"
+#include "HvUtils.h"
+#include "DL3YBatch.hpp"
+#include "DL3YEngine.hpp"
+#include "DL3YVectorBlocks.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+struct BenchParam {
+    const char* name;
+    float min;
+    float max;
+    float def;
+};
+
+// same order, ranges and defaults as the @hv_param receivers in WSTD_DL3Y.pd,
+// Quality is left at Normal, the graph does not implement it
+static const BenchParam kParams[] = {
+    { "High",           -15.0f,   15.0f,    0.0f },
+    { "High_Cross",       0.0f,  100.0f,   20.0f },
+    { "High_Feedback",    0.0f,  100.0f,   25.0f },
+    { "High_Mix",         0.0f,  100.0f,   50.0f },
+    { "High_Sync",        0.0f,    1.0f,    0.0f },
+    { "High_Time",       50.0f, 5000.0f,  500.0f },
+    { "High_TimeSync",    0.0f,   12.0f,    6.0f },
+    { "Low",            -15.0f,   15.0f,    0.0f },
+    { "Low_Cross",        0.0f,  100.0f,   20.0f },
+    { "Low_Feedback",     0.0f,  100.0f,   25.0f },
+    { "Low_Mix",          0.0f,  100.0f,   50.0f },
+    { "Low_Sync",         0.0f,    1.0f,    0.0f },
+    { "Low_Time",        50.0f, 5000.0f,  500.0f },
+    { "Low_TimeSync",     0.0f,   12.0f,    6.0f },
+    { "Mid",            -15.0f,   15.0f,    0.0f },
+    { "Mid_Cross",        0.0f,  100.0f,   20.0f },
+    { "Mid_Feedback",     0.0f,  100.0f,   25.0f },
+    { "Mid_Freq",       313.3f, 5705.6f, 1337.0f },
+    { "Mid_Mix",          0.0f,  100.0f,   50.0f },
+    { "Mid_Sync",         0.0f,    1.0f,    0.0f },
+    { "Mid_Time",        50.0f, 5000.0f,  500.0f },
+    { "Mid_TimeSync",     0.0f,   12.0f,    6.0f },
+};
+
+static const int kNumParams = sizeof(kParams) / sizeof(kParams[0]);
+static const int kSyncParams[] = { 4, 11, 19 };
+
+static const int kBatchSizes[] = { 8, 32, 64 };
+static const double kBatchSampleRate = 48000.0;
+static const int kBatchBlockSize = 64;
+
+static const int kNativeBlockSizes[] = { 32, 256 };
+
+// block size of the live setting, and the long blocks its per block cost is measured against
+static const int kLiveBlockSize = 32;
+static const int kLongBlockSize = 4096;
+
+static const char* const kQualityNames[kDL3YQualityCount] = { "eco", "normal", "high" };
+
+static const double kSampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+static const int kBlockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+enum BenchCase {
+    kCaseStatic,
+    kCaseAutomation,
+    kCaseTempo,
+    kNumCases
+};
+
+static const char* const kCaseNames[kNumCases] = { "static", "automation", "tempo" };
+
+// quality is compared with fixed and with gliding delay times
+static const BenchCase kQualityCases[] = { kCaseStatic, kCaseTempo };
+
+struct BenchResult {
+    double nsPerSample;
+    double realtimeFactor;
+    double worstBlockUs;
+    double worstBlockLoad;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Deterministic test signal: noise bursts with a decaying envelope, different per channel,
+   so every band has content to delay and feed back.
+ */
+static void fillInput(std::vector<float>& left, std::vector<float>& right, double sampleRate)
+{
+    uint32_t seed = 0x9e3779b9;
+    const size_t burstLength = (size_t)(sampleRate * 0.25);
+    float env = 0.0f;
+
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        if (i % burstLength == 0)
+            env = 0.5f;
+        env *= 0.9997f;
+
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        const float l = (float)(seed & 0xffff) / 32768.0f - 1.0f;
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        const float r = (float)(seed & 0xffff) / 32768.0f - 1.0f;
+
+        left[i] = env * l;
+        right[i] = env * (0.5f * l + 0.5f * r);
+    }
+}
+
+static void sendParam(HeavyContextInterface* context, const hv_uint32_t* hashes, int index, float value)
+{
+    hv_sendFloatToReceiver(context, hashes[index], value);
+}
+
+static float sweep(const BenchParam& param, float phase)
+{
+    // triangle over the full range
+    const float tri = phase < 0.5f ? 2.0f * phase : 2.0f - 2.0f * phase;
+    return param.min + tri * (param.max - param.min);
+}
+
+static BenchResult runCase(BenchCase benchCase, double sampleRate, int blockSize, double seconds)
+{
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+
+    std::vector<float> inL(numFrames), inR(numFrames);
+    std::vector<float> outL(blockSize), outR(blockSize);
+    fillInput(inL, inR, sampleRate);
+
+    HeavyContextInterface* const context = hv_WSTD_DL3Y_new(sampleRate);
+
+    hv_uint32_t hashes[kNumParams];
+    for (int i = 0; i < kNumParams; ++i)
+        hashes[i] = hv_stringToHash(kParams[i].name);
+    const hv_uint32_t bpmHash = hv_stringToHash("__hv_dpf_bpm");
+
+    for (int i = 0; i < kNumParams; ++i)
+        sendParam(context, hashes, i, kParams[i].def);
+
+    if (benchCase == kCaseTempo)
+    {
+        for (int i = 0; i < 3; ++i)
+            sendParam(context, hashes, kSyncParams[i], 1.0f);
+    }
+
+    // one block to let the loadbang and initial messages settle
+    {
+        float* ins[2] = { inL.data(), inR.data() };
+        float* outs[2] = { outL.data(), outR.data() };
+        hv_process(context, ins, outs, blockSize);
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double totalNs = 0.0;
+    double worstNs = 0.0;
+
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+        float* ins[2] = { inL.data() + b * blockSize, inR.data() + b * blockSize };
+        float* outs[2] = { outL.data(), outR.data() };
+        const float phase = (float)std::fmod((double)(b * blockSize) / sampleRate * 0.5, 1.0);
+
+        const Clock::time_point start = Clock::now();
+
+        switch (benchCase)
+        {
+        case kCaseStatic:
+            break;
+        case kCaseAutomation:
+            for (int i = 0; i < kNumParams; ++i)
+                sendParam(context, hashes, i, sweep(kParams[i], std::fmod(phase + (float)i / kNumParams, 1.0f)));
+            break;
+        case kCaseTempo:
+            hv_sendFloatToReceiver(context, bpmHash, 60.0f + 120.0f * phase);
+            break;
+        default:
+            break;
+        }
+
+        hv_process(context, ins, outs, blockSize);
+
+        const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        totalNs += ns;
+        if (ns > worstNs)
+            worstNs = ns;
+    }
+
+    hv_delete(context);
+
+    const double blockNs = 1e9 * blockSize / sampleRate;
+
+    BenchResult result;
+    result.nsPerSample = totalNs / (double)numFrames;
+    result.realtimeFactor = (1e9 * (double)numFrames / sampleRate) / totalNs;
+    result.worstBlockUs = worstNs / 1000.0;
+    result.worstBlockLoad = 100.0 * worstNs / blockNs;
+    return result;
+}
+
+/**
+   Throughput of numInstances DL3Y instances, either as separate Heavy contexts or as one DL3YBatch.
+   Every instance gets its own delay times so the batch delay reads really diverge.
+   Returns ns per stereo frame per instance.
+ */
+static double runBatch(int numInstances, bool batched, double seconds)
+{
+    const double sampleRate = kBatchSampleRate;
+    const int blockSize = kBatchBlockSize;
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+
+    std::vector<float> inL(numFrames), inR(numFrames);
+    std::vector<float> outs(2 * numInstances * blockSize);
+    fillInput(inL, inR, sampleRate);
+
+    std::vector<const float*> inPtrs(2 * numInstances);
+    std::vector<float*> outPtrs(2 * numInstances);
+    for (int i = 0; i < 2 * numInstances; ++i)
+        outPtrs[i] = outs.data() + i * blockSize;
+
+    DL3YBatch* batch = nullptr;
+    std::vector<HeavyContextInterface*> contexts;
+    hv_uint32_t hashes[kNumParams];
+
+    if (batched)
+    {
+        batch = new DL3YBatch(numInstances, sampleRate);
+
+        for (int i = 0; i < numInstances; ++i)
+            for (int p = 0; p < 3; ++p)
+                batch->setParameter(i, kDL3YBandParameters[p].time, 200.0f + 37.0f * i + 100.0f * p);
+    }
+    else
+    {
+        for (int p = 0; p < kNumParams; ++p)
+            hashes[p] = hv_stringToHash(kParams[p].name);
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            HeavyContextInterface* const context = hv_WSTD_DL3Y_new(sampleRate);
+
+            for (int p = 0; p < kNumParams; ++p)
+                sendParam(context, hashes, p, kParams[p].def);
+            for (int p = 0; p < 3; ++p)
+                sendParam(context, hashes, kDL3YBandParameters[p].time, 200.0f + 37.0f * i + 100.0f * p);
+
+            contexts.push_back(context);
+        }
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+        for (int i = 0; i < numInstances; ++i)
+        {
+            inPtrs[2 * i] = inL.data() + b * blockSize;
+            inPtrs[2 * i + 1] = inR.data() + b * blockSize;
+        }
+
+        if (batched)
+        {
+            batch->process(inPtrs.data(), outPtrs.data(), blockSize);
+        }
+        else
+        {
+            for (int i = 0; i < numInstances; ++i)
+            {
+                float* ins[2] = { const_cast<float*>(inPtrs[2 * i]), const_cast<float*>(inPtrs[2 * i + 1]) };
+                hv_process(contexts[i], ins, outPtrs.data() + 2 * i, blockSize);
+            }
+        }
+    }
+
+    const double totalNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+    delete batch;
+    for (size_t i = 0; i < contexts.size(); ++i)
+        hv_delete(contexts[i]);
+
+    return totalNs / (double)numFrames / numInstances;
+}
+
+struct NativeResult {
+    double heavyNs;
+    double nativeNs;
+    double maxDiff;
+    double rmsDiffDb;
+};
+
+/**
+   The same input and parameters through the Heavy context and DL3YEngine.
+   Heavy is the reference: the difference is reported as peak and as RMS relative to the Heavy output.
+ */
+static NativeResult runNative(BenchCase benchCase, double sampleRate, int blockSize, double seconds)
+{
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+
+    std::vector<float> inL(numFrames), inR(numFrames);
+    std::vector<float> heavyL(numFrames), heavyR(numFrames), nativeL(numFrames), nativeR(numFrames);
+    fillInput(inL, inR, sampleRate);
+
+    HeavyContextInterface* const context = hv_WSTD_DL3Y_new(sampleRate);
+    DL3YEngine* const engine = new DL3YEngine(sampleRate);
+
+    hv_uint32_t hashes[kNumParams];
+    for (int i = 0; i < kNumParams; ++i)
+    {
+        hashes[i] = hv_stringToHash(kParams[i].name);
+        sendParam(context, hashes, i, kParams[i].def);
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double heavyNs = 0.0;
+    double nativeNs = 0.0;
+
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+        const size_t offset = b * blockSize;
+        float* ins[2] = { inL.data() + offset, inR.data() + offset };
+        float* heavyOuts[2] = { heavyL.data() + offset, heavyR.data() + offset };
+        float* nativeOuts[2] = { nativeL.data() + offset, nativeR.data() + offset };
+        const float phase = (float)std::fmod((double)offset / sampleRate * 0.5, 1.0);
+
+        Clock::time_point start = Clock::now();
+
+        if (benchCase == kCaseAutomation)
+        {
+            for (int i = 0; i < kNumParams; ++i)
+                sendParam(context, hashes, i, sweep(kParams[i], std::fmod(phase + (float)i / kNumParams, 1.0f)));
+        }
+        hv_process(context, ins, heavyOuts, blockSize);
+
+        heavyNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        start = Clock::now();
+
+        if (benchCase == kCaseAutomation)
+        {
+            for (int i = 0; i < kNumParams; ++i)
+                engine->setParameter(i, sweep(kParams[i], std::fmod(phase + (float)i / kNumParams, 1.0f)));
+        }
+        engine->process<float>(ins, nativeOuts, blockSize);
+
+        nativeNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    hv_delete(context);
+    delete engine;
+
+    double maxDiff = 0.0, diffSum = 0.0, refSum = 0.0;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const double dl = (double)nativeL[i] - heavyL[i];
+        const double dr = (double)nativeR[i] - heavyR[i];
+
+        maxDiff = std::fmax(maxDiff, std::fmax(std::fabs(dl), std::fabs(dr)));
+        diffSum += dl * dl + dr * dr;
+        refSum += (double)heavyL[i] * heavyL[i] + (double)heavyR[i] * heavyR[i];
+    }
+
+    NativeResult result;
+    result.heavyNs = heavyNs / (double)numFrames;
+    result.nativeNs = nativeNs / (double)numFrames;
+    result.maxDiff = maxDiff;
+    result.rmsDiffDb = 10.0 * std::log10((diffSum + 1e-30) / (refSum + 1e-30));
+    return result;
+}
+
+/**
+   DL3YEngine at every quality on the same input, static: fractional band delay times left alone,
+   tempo: all bands synced to a tempo that changes every block, so the delay times keep gliding.
+   Differences are against Normal.
+ */
+struct QualityResult {
+    double nsPerSample;
+    double maxDiff;
+    double rmsDiffDb;
+};
+
+static void runQuality(BenchCase benchCase, double seconds, QualityResult results[kDL3YQualityCount])
+{
+    const double sampleRate = kBatchSampleRate;
+    const int blockSize = kBatchBlockSize;
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+
+    std::vector<float> inL(numFrames), inR(numFrames);
+    std::vector<float> outs[kDL3YQualityCount][2];
+    fillInput(inL, inR, sampleRate);
+
+    typedef std::chrono::steady_clock Clock;
+
+    for (uint32_t q = 0; q < kDL3YQualityCount; ++q)
+    {
+        DL3YEngine* const engine = new DL3YEngine(sampleRate);
+        engine->setParameter(kDL3YQuality, (float)q);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            if (benchCase == kCaseTempo)
+                engine->setParameter(kDL3YBandParameters[b].sync, 1.0f);
+            else
+                engine->setParameter(kDL3YBandParameters[b].time, 333.3f + 101.7f * b);
+        }
+
+        outs[q][0].resize(numFrames);
+        outs[q][1].resize(numFrames);
+
+        const Clock::time_point start = Clock::now();
+
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            const size_t offset = b * blockSize;
+            const float* ins[2] = { inL.data() + offset, inR.data() + offset };
+            float* outPtrs[2] = { outs[q][0].data() + offset, outs[q][1].data() + offset };
+
+            if (benchCase == kCaseTempo)
+                engine->setBpm(60.0f + 120.0f * (float)std::fmod((double)offset / sampleRate * 0.5, 1.0));
+
+            engine->process(ins, outPtrs, blockSize);
+        }
+
+        results[q].nsPerSample = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()
+                            / (double)numFrames;
+        delete engine;
+    }
+
+    const std::vector<float>* const ref = outs[kDL3YQualityNormal];
+
+    for (uint32_t q = 0; q < kDL3YQualityCount; ++q)
+    {
+        double maxDiff = 0.0, diffSum = 0.0, refSum = 0.0;
+
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            for (size_t i = 0; i < numFrames; ++i)
+            {
+                const double d = (double)outs[q][c][i] - ref[c][i];
+                maxDiff = std::fmax(maxDiff, std::fabs(d));
+                diffSum += d * d;
+                refSum += (double)ref[c][i] * ref[c][i];
+            }
+        }
+
+        results[q].maxDiff = maxDiff;
+        results[q].rmsDiffDb = 10.0 * std::log10((diffSum + 1e-30) / (refSum + 1e-30));
+    }
+}
+
+/**
+   DL3YEngine on a mono source sent to both inputs, with a stereo passage in the middle, processed with
+   both channels and with mono detection. The outputs should not differ at all.
+ */
+struct MonoResult {
+    double stereoNs;
+    double monoNs;
+    double maxDiff;
+};
+
+static MonoResult runMono(double seconds)
+{
+    const double sampleRate = kBatchSampleRate;
+    const int blockSize = kBatchBlockSize;
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+
+    std::vector<float> inL(numFrames), inR(numFrames);
+    std::vector<float> outs[2][2];
+    fillInput(inL, inR, sampleRate);
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        if (i < numFrames * 2 / 5 || i >= numFrames * 3 / 5)
+            inR[i] = inL[i];
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double ns[2];
+
+    for (int m = 0; m < 2; ++m)
+    {
+        DL3YEngine* const engine = new DL3YEngine(sampleRate);
+        engine->setMonoDetection(m == 1);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+            engine->setParameter(kDL3YBandParameters[b].time, 333.3f + 101.7f * b);
+
+        outs[m][0].resize(numFrames);
+        outs[m][1].resize(numFrames);
+
+        const Clock::time_point start = Clock::now();
+
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            const size_t offset = b * blockSize;
+            const float* ins[2] = { inL.data() + offset, inR.data() + offset };
+            float* outPtrs[2] = { outs[m][0].data() + offset, outs[m][1].data() + offset };
+
+            engine->process(ins, outPtrs, blockSize);
+        }
+
+        ns[m] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()
+              / (double)numFrames;
+        delete engine;
+    }
+
+    double maxDiff = 0.0;
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        for (size_t i = 0; i < numFrames; ++i)
+            maxDiff = std::fmax(maxDiff, std::fabs((double)outs[1][c][i] - outs[0][c][i]));
+    }
+
+    MonoResult result;
+    result.stereoNs = ns[0];
+    result.monoNs = ns[1];
+    result.maxDiff = maxDiff;
+    return result;
+}
+
+/**
+   Fixed cost per process() call at the live block size: the time of one such block minus the time
+   the same frames take in long blocks. Heavy runs directly on aligned buffers, as the DPF wrapper
+   used to call it, through DL3YVectorBlocks on aligned buffers (in place) and on buffers one frame
+   off alignment (through its scratch), and with blocks one frame short of whole vectors (the frames
+   short of a vector carried to the next block); the native engine works on the host buffers at any size and alignment.
+ */
+enum BlockPath {
+    kPathHeavy,
+    kPathVectorBlocks,
+    kPathMisaligned,
+    kPathPartialVector,
+    kPathNative,
+    kNumPaths
+};
+
+static const char* const kPathNames[kNumPaths] = { "heavy", "vector", "misaligned", "partial", "native" };
+
+struct BlockResult {
+    int blockSize;
+    double blockNs;
+    double nsPerSample;
+    double overheadNs;
+};
+
+// frames of storage starting on a whole SIMD vector, plus offset
+static float* alignedFrames(std::vector<float>& storage, const size_t frames, const size_t offset)
+{
+    const uintptr_t mask = HV_N_SIMD * sizeof(float) - 1;
+
+    storage.assign(frames + offset + HV_N_SIMD, 0.0f);
+    return reinterpret_cast<float*>((reinterpret_cast<uintptr_t>(storage.data()) + mask) & ~mask) + offset;
+}
+
+static double runBlocks(BlockPath path, int blockSize, double seconds)
+{
+    const double sampleRate = kBatchSampleRate;
+    const size_t numBlocks = (size_t)std::ceil(seconds * sampleRate / blockSize);
+    const size_t numFrames = numBlocks * blockSize;
+    const size_t offset = path == kPathMisaligned ? 1 : 0;
+
+    std::vector<float> storage[4];
+    float* const inL = alignedFrames(storage[0], numFrames, offset);
+    float* const inR = alignedFrames(storage[1], numFrames, offset);
+    float* const outL = alignedFrames(storage[2], numFrames, offset);
+    float* const outR = alignedFrames(storage[3], numFrames, offset);
+
+    {
+        std::vector<float> left(numFrames), right(numFrames);
+        fillInput(left, right, sampleRate);
+        std::copy(left.begin(), left.end(), inL);
+        std::copy(right.begin(), right.end(), inR);
+    }
+
+    HeavyContextInterface* const context = hv_WSTD_DL3Y_new(sampleRate);
+    DL3YEngine* const engine = new DL3YEngine(sampleRate);
+    DL3YVectorBlocks<HV_N_SIMD>* const vectorBlocks = new DL3YVectorBlocks<HV_N_SIMD>;
+    const auto process = [context](float** ins, float** outs, int n) { hv_process(context, ins, outs, n); };
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+        float* ins[2] = { inL + b * blockSize, inR + b * blockSize };
+        float* outs[2] = { outL + b * blockSize, outR + b * blockSize };
+
+        switch (path)
+        {
+        case kPathHeavy:
+            hv_process(context, ins, outs, blockSize);
+            break;
+        case kPathNative:
+            engine->process<float>(ins, outs, blockSize);
+            break;
+        default:
+            vectorBlocks->run(process, ins, outs, blockSize);
+            break;
+        }
+    }
+
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+    hv_delete(context);
+    delete engine;
+    delete vectorBlocks;
+
+    return ns / (double)numFrames;
+}
+
+static BlockResult runBlockOverhead(BlockPath path, double seconds)
+{
+    // the partial path runs blocks one frame short of whole vectors, also in the long run
+    const int shorten = path == kPathPartialVector ? 1 : 0;
+    const int liveBlockSize = kLiveBlockSize - shorten;
+    const double liveNs = runBlocks(path, liveBlockSize, seconds);
+    const double longNs = runBlocks(path, kLongBlockSize - shorten, seconds);
+
+    BlockResult result;
+    result.blockSize = liveBlockSize;
+    result.blockNs = liveNs * liveBlockSize;
+    result.nsPerSample = liveNs;
+    result.overheadNs = (liveNs - longNs) * liveBlockSize;
+    return result;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+
+    if (seconds <= 0.0)
+    {
+        std::fprintf(stderr, "usage: %s [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("WSTD_DL3Y headless benchmark, %.1f s of stereo audio per run\n", seconds);
+    std::printf("ns/sample is per stereo frame, worst block load is relative to the block's realtime budget\n\n");
+    std::printf("%-11s %8s %6s %11s %11s %14s %10s\n",
+                "case", "rate", "block", "ns/sample", "realtime", "worst block", "load");
+
+    for (int c = 0; c < kNumCases; ++c)
+    {
+        for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(kSampleRates[0]); ++r)
+        {
+            for (size_t s = 0; s < sizeof(kBlockSizes) / sizeof(kBlockSizes[0]); ++s)
+            {
+                const BenchResult res = runCase((BenchCase)c, kSampleRates[r], kBlockSizes[s], seconds);
+
+                std::printf("%-11s %8.0f %6d %11.2f %10.1fx %11.1f us %9.1f%%\n",
+                            kCaseNames[c], kSampleRates[r], kBlockSizes[s],
+                            res.nsPerSample, res.realtimeFactor, res.worstBlockUs, res.worstBlockLoad);
+                std::fflush(stdout);
+            }
+        }
+        std::printf("\n");
+    }
+
+    std::printf("batch throughput at %.0f Hz, block %d, ns/sample per instance\n", kBatchSampleRate, kBatchBlockSize);
+    std::printf("%-11s %14s %14s %10s\n", "instances", "heavy", "DL3YBatch", "speedup");
+
+    for (size_t n = 0; n < sizeof(kBatchSizes) / sizeof(kBatchSizes[0]); ++n)
+    {
+        const double heavyNs = runBatch(kBatchSizes[n], false, seconds);
+        const double batchNs = runBatch(kBatchSizes[n], true, seconds);
+
+        std::printf("%-11d %14.2f %14.2f %9.1fx\n", kBatchSizes[n], heavyNs, batchNs, heavyNs / batchNs);
+        std::fflush(stdout);
+    }
+
+    std::printf("\nnative DL3YEngine against the heavy reference, ns/sample and output difference\n");
+    std::printf("%-11s %8s %6s %11s %11s %9s %12s %12s\n",
+                "case", "rate", "block", "heavy", "native", "speedup", "peak diff", "rms diff");
+
+    for (int c = kCaseStatic; c <= kCaseAutomation; ++c)
+    {
+        for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(kSampleRates[0]); ++r)
+        {
+            for (size_t s = 0; s < sizeof(kNativeBlockSizes) / sizeof(kNativeBlockSizes[0]); ++s)
+            {
+                const NativeResult res = runNative((BenchCase)c, kSampleRates[r], kNativeBlockSizes[s], seconds);
+
+                std::printf("%-11s %8.0f %6d %11.2f %11.2f %8.1fx %12.6f %9.1f dB\n",
+                            kCaseNames[c], kSampleRates[r], kNativeBlockSizes[s],
+                            res.heavyNs, res.nativeNs, res.heavyNs / res.nativeNs, res.maxDiff, res.rmsDiffDb);
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    std::printf("\nDL3YEngine quality at %.0f Hz, block %d, ns/sample and output difference against normal\n",
+                kBatchSampleRate, kBatchBlockSize);
+    std::printf("%-11s %8s %11s %9s %12s %12s\n", "case", "quality", "ns/sample", "cost", "peak diff", "rms diff");
+
+    for (size_t c = 0; c < sizeof(kQualityCases) / sizeof(kQualityCases[0]); ++c)
+    {
+        QualityResult res[kDL3YQualityCount];
+        runQuality(kQualityCases[c], seconds, res);
+
+        for (uint32_t q = 0; q < kDL3YQualityCount; ++q)
+        {
+            std::printf("%-11s %8s %11.2f %8.2fx %12.6f %9.1f dB\n",
+                        kCaseNames[kQualityCases[c]], kQualityNames[q], res[q].nsPerSample,
+                        res[q].nsPerSample / res[kDL3YQualityNormal].nsPerSample,
+                        res[q].maxDiff, q == kDL3YQualityNormal ? 0.0 : res[q].rmsDiffDb);
+            std::fflush(stdout);
+        }
+    }
+
+    std::printf("\nDL3YEngine on mono input (stereo for the middle fifth) at %.0f Hz, block %d, ns/sample\n",
+                kBatchSampleRate, kBatchBlockSize);
+    std::printf("%11s %11s %9s %12s\n", "stereo", "mono", "speedup", "peak diff");
+
+    const MonoResult mono = runMono(seconds);
+    std::printf("%11.2f %11.2f %8.2fx %12.6f\n", mono.stereoNs, mono.monoNs, mono.stereoNs / mono.monoNs, mono.maxDiff);
+
+    std::printf("\nper block cost at %.0f Hz, %d frame blocks against %d, heavy vectors of %d frames\n",
+                kBatchSampleRate, kLiveBlockSize, kLongBlockSize, HV_N_SIMD);
+    std::printf("%-11s %6s %11s %11s %15s\n", "path", "block", "ns/block", "ns/sample", "overhead/block");
+
+    for (int p = 0; p < kNumPaths; ++p)
+    {
+        const BlockResult res = runBlockOverhead((BlockPath)p, seconds);
+        std::printf("%-11s %6d %11.1f %11.2f %12.1f ns\n",
+                    kPathNames[p], res.blockSize, res.blockNs, res.nsPerSample, res.overheadNs);
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,480 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_BATCH_HPP_INCLUDED
+#define DL3Y_BATCH_HPP_INCLUDED
+
+#include "DL3YControls.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   N independent DL3Y instances processed in one call.
+
+   Instances are processed in groups of kLanes. Within a group all state (crossover coefficients and
+   filters, parameter ramps, delay times) is stored struct-of-arrays, one row of kLanes values per
+   state variable, and audio is transposed to one row per frame. The kernels loop over the lanes of a
+   row, so the compiler vectorizes across instances instead of across samples while the recursive
+   filters and feedback loops stay sample-by-sample per instance.
+
+   Delay lines are the exception: every instance reads at its own delay time, so each keeps its own
+   contiguous line in one shared arena and all lines share a single write position. Per sub-block the
+   read positions are computed across lanes, the interpolated reads done per instance (consecutive
+   frames stay on the same cache line), the feedback mixed across lanes and written back per instance.
+   The shortest delay (50 ms) is longer than a sub-block, so a sub-block never reads what it writes.
+
+   Parameters use the @hv_param receiver semantics and plugin indices (see DL3YParameters.hpp),
+   changes are applied at the start of the next process() call and ramped over one sub-block.
+   Quality is stored but not used, every instance runs at Normal.
+
+   Memory is roughly 6 lines x 5 s x sample rate x instances floats, the same as N Heavy contexts.
+   The caller should run process() with denormals flushed to zero, like DPF does for plugins.
+ */
+class DL3YBatch
+{
+public:
+    // instances per group, the vector width the kernels are written for
+    static const uint32_t kLanes = 8;
+
+    // frames per transposed sub-block
+    static const uint32_t kMaxBlock = 32;
+
+    DL3YBatch(const uint32_t numInstances, const double sampleRate)
+        : fNumInstances(numInstances),
+          fNumGroups((numInstances + kLanes - 1) / kLanes),
+          fSampleRate(sampleRate),
+          fCrossoverTable(dl3yCrossoverTable(sampleRate)),
+          fLineLength((uint32_t)std::ceil(kDL3YMaxTimeMs * 0.001 * sampleRate) + kDL3YLineGuard),
+          fTimeCoeff((float)(1.0 - std::exp(-1.0 / (kDL3YTimeSmoothingSeconds * sampleRate)))),
+          fWriteIndex(0),
+          fParameters(kDL3YParameterCount * numInstances),
+          fBpm(numInstances, kDL3YDefaultBpm),
+          fDirty(numInstances, 1),
+          fState(fNumGroups * kStateCount * kLanes, 0.0f),
+          fInput(fNumGroups * 2 * kMaxBlock * kLanes, 0.0f),
+          fOutput(fNumGroups * 2 * kMaxBlock * kLanes, 0.0f),
+          fLines((size_t)kLineCount * fLineLength * numInstances, 0.0f)
+    {
+        for (uint32_t i = 0; i < numInstances; ++i)
+        {
+            for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+                fParameters[i * kDL3YParameterCount + p] = kDL3YParameterRanges[p].def;
+        }
+
+        updateTargets();
+
+        // start settled on the defaults, no ramp or glide on the first block
+        for (uint32_t g = 0; g < fNumGroups; ++g)
+        {
+            for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+            {
+                commitRamps(g, b);
+                std::memcpy(row(g, bandRow(b, kDelay)), row(g, bandRow(b, kDelayTarget)), kLanes * sizeof(float));
+            }
+        }
+
+        std::memset(fSplit, 0, sizeof(fSplit));
+        std::memset(fReadIndex, 0, sizeof(fReadIndex));
+        std::memset(fFrac, 0, sizeof(fFrac));
+        std::memset(fReadL, 0, sizeof(fReadL));
+        std::memset(fReadR, 0, sizeof(fReadR));
+    }
+
+    uint32_t getNumInstances() const noexcept { return fNumInstances; }
+    double getSampleRate() const noexcept { return fSampleRate; }
+
+    float getParameter(const uint32_t instance, const uint32_t index) const noexcept
+    {
+        return fParameters[instance * kDL3YParameterCount + index];
+    }
+
+    void setParameter(const uint32_t instance, const uint32_t index, const float value) noexcept
+    {
+        if (instance >= fNumInstances || index >= kDL3YParameterCount)
+            return;
+
+        const DL3YParameterRange& range(kDL3YParameterRanges[index]);
+        fParameters[instance * kDL3YParameterCount + index] = std::max(range.min, std::min(range.max, value));
+        fDirty[instance] = 1;
+    }
+
+    /**
+       Host tempo of one instance, the __hv_dpf_bpm receiver.
+     */
+    void setBpm(const uint32_t instance, const float bpm) noexcept
+    {
+        if (instance >= fNumInstances || bpm <= 0.0f || fBpm[instance] == bpm)
+            return;
+
+        fBpm[instance] = bpm;
+        fDirty[instance] = 1;
+    }
+
+    /**
+       Clear all delay lines and filter states, parameters are kept.
+     */
+    void reset() noexcept
+    {
+        std::fill(fLines.begin(), fLines.end(), 0.0f);
+
+        for (uint32_t g = 0; g < fNumGroups; ++g)
+            std::fill_n(row(g, kIc1L), (kIc2R - kIc1L + 1) * kLanes, 0.0f);
+    }
+
+    /**
+       Process all instances.
+       inputs and outputs hold 2 x numInstances channel pointers: instance i uses [2*i] and [2*i + 1].
+     */
+    void process(const float* const* const inputs, float* const* const outputs, const uint32_t frames) noexcept
+    {
+        updateTargets();
+
+        for (uint32_t offset = 0; offset < frames;)
+        {
+            const uint32_t n = std::min(frames - offset, kMaxBlock);
+
+            for (uint32_t i = 0; i < fNumInstances; ++i)
+            {
+                float* const inL = audio(fInput, i / kLanes, 0) + i % kLanes;
+                float* const inR = audio(fInput, i / kLanes, 1) + i % kLanes;
+                const float* const srcL = inputs[2 * i] + offset;
+                const float* const srcR = inputs[2 * i + 1] + offset;
+
+                for (uint32_t t = 0; t < n; ++t)
+                {
+                    inL[t * kLanes] = srcL[t];
+                    inR[t * kLanes] = srcR[t];
+                }
+            }
+
+            for (uint32_t g = 0; g < fNumGroups; ++g)
+                processGroup(g, n);
+
+            fWriteIndex = (fWriteIndex + n) % fLineLength;
+
+            for (uint32_t i = 0; i < fNumInstances; ++i)
+            {
+                const float* const outL = audio(fOutput, i / kLanes, 0) + i % kLanes;
+                const float* const outR = audio(fOutput, i / kLanes, 1) + i % kLanes;
+                float* const dstL = outputs[2 * i] + offset;
+                float* const dstR = outputs[2 * i + 1] + offset;
+
+                for (uint32_t t = 0; t < n; ++t)
+                {
+                    dstL[t] = outL[t * kLanes];
+                    dstR[t] = outR[t * kLanes];
+                }
+            }
+
+            offset += n;
+        }
+    }
+
+private:
+    // ----------------------------------------------------------------------------------------------------------------
+    // State rows of a group
+
+    // per band: ramped values (current, then target) and the glided delay time in frames
+    enum BandField {
+        kGain,
+        kFeedback,
+        kCross,
+        kMix,
+        kRampCount,
+        kRampTarget = kRampCount,
+        kDelay = kRampTarget + kRampCount,
+        kDelayTarget,
+        kBandFieldCount
+    };
+
+    enum Row {
+        // crossover coefficients
+        kA1,
+        kA2,
+        kA3,
+        kK,
+        // crossover states, left and right
+        kIc1L,
+        kIc2L,
+        kIc1R,
+        kIc2R,
+        kBandRows,
+        kStateCount = kBandRows + kBandFieldCount * kDL3YBandCount
+    };
+
+    static const uint32_t kLineCount = 2 * kDL3YBandCount;
+
+    static uint32_t bandRow(const uint32_t band, const uint32_t field) noexcept { return kBandRows + band * kBandFieldCount + field; }
+
+    float* row(const uint32_t group, const uint32_t r) noexcept { return &fState[(group * kStateCount + r) * kLanes]; }
+    float* audio(std::vector<float>& buffer, const uint32_t group, const uint32_t channel) noexcept { return &buffer[(group * 2 + channel) * kMaxBlock * kLanes]; }
+    float* line(const uint32_t band, const uint32_t channel, const uint32_t instance) noexcept
+    {
+        return &fLines[((size_t)(2 * band + channel) * fNumInstances + instance) * fLineLength];
+    }
+
+    void commitRamps(const uint32_t group, const uint32_t band) noexcept
+    {
+        std::memcpy(row(group, bandRow(band, 0)), row(group, bandRow(band, kRampTarget)), kRampCount * kLanes * sizeof(float));
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+
+    /**
+       Fold the parameter chains of changed instances into ramp targets and filter coefficients,
+       the same folding as DL3YControls.
+     */
+    void updateTargets() noexcept
+    {
+        const float maxDelay = (float)(fLineLength - kDL3YLineGuard);
+
+        for (uint32_t i = 0; i < fNumInstances; ++i)
+        {
+            if (! fDirty[i])
+                continue;
+            fDirty[i] = 0;
+
+            const uint32_t g = i / kLanes;
+            const uint32_t lane = i % kLanes;
+
+            const float freq = getParameter(i, kDL3YMid_Freq);
+            const DL3YCrossoverCoeffs c = fCrossoverTable != nullptr ? fCrossoverTable->lookup(freq)
+                                                                     : dl3yCrossoverCoeffs(freq, fSampleRate);
+            row(g, kA1)[lane] = c.a1;
+            row(g, kA2)[lane] = c.a2;
+            row(g, kA3)[lane] = c.a3;
+            row(g, kK)[lane] = c.k;
+
+            const float beatMs = dl3yBeatMs(fBpm[i]);
+
+            for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+            {
+                const DL3YBandValues v = dl3yFoldBand(&fParameters[i * kDL3YParameterCount], b, beatMs, fSampleRate);
+
+                row(g, bandRow(b, kRampTarget + kGain))[lane] = v.gain;
+                row(g, bandRow(b, kRampTarget + kFeedback))[lane] = v.feedback;
+                row(g, bandRow(b, kRampTarget + kCross))[lane] = v.cross;
+                row(g, bandRow(b, kRampTarget + kMix))[lane] = v.mix;
+                row(g, bandRow(b, kDelayTarget))[lane] = std::min(v.delayFrames, maxDelay);
+            }
+        }
+    }
+
+    void processGroup(const uint32_t group, const uint32_t frames) noexcept
+    {
+        const float* const inL = audio(fInput, group, 0);
+        const float* const inR = audio(fInput, group, 1);
+        float* const outL = audio(fOutput, group, 0);
+        float* const outR = audio(fOutput, group, 1);
+        float* const state = row(group, 0);
+
+        for (uint32_t t = 0; t < frames; ++t)
+            splitFrame(inL + t * kLanes, inR + t * kLanes, state, fSplit[0] + t * kLanes, outL + t * kLanes, outR + t * kLanes);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            processBand(group, b, frames);
+            commitRamps(group, b);
+        }
+    }
+
+    /**
+       One band's dlay for the instances of a group over the sub-block, summed into the output.
+     */
+    void processBand(const uint32_t group, const uint32_t band, const uint32_t frames) noexcept
+    {
+        const uint32_t first = group * kLanes;
+        const uint32_t lanes = std::min(kLanes, fNumInstances - first);
+        const int32_t length = (int32_t)fLineLength;
+        const float invFrames = 1.0f / (float)frames;
+        float* const fields = row(group, bandRow(band, 0));
+        float* const outL = audio(fOutput, group, 0);
+        float* const outR = audio(fOutput, group, 1);
+
+        int32_t write = (int32_t)fWriteIndex;
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            delayPositions(fields + kDelay * kLanes, fields + kDelayTarget * kLanes, fTimeCoeff, write, length, fReadIndex[t], fFrac[t]);
+
+            if (++write == length)
+                write = 0;
+        }
+
+        for (uint32_t lane = 0; lane < lanes; ++lane)
+        {
+            const float* const l = line(band, 0, first + lane);
+            const float* const r = line(band, 1, first + lane);
+
+            for (uint32_t t = 0; t < frames; ++t)
+            {
+                // taps at d - 1, d, d + 1 and d + 2 frames behind the write position
+                const int32_t r0 = fReadIndex[t][lane];
+                const int32_t rm1 = r0 + 1 < length ? r0 + 1 : r0 + 1 - length;
+                const int32_t r1 = r0 > 0 ? r0 - 1 : r0 - 1 + length;
+                const int32_t r2 = r1 > 0 ? r1 - 1 : r1 - 1 + length;
+                const float frac = fFrac[t][lane];
+
+                fReadL[t][lane] = dl3yHermite(l[rm1], l[r0], l[r1], l[r2], frac);
+                fReadR[t][lane] = dl3yHermite(r[rm1], r[r0], r[r1], r[r2], frac);
+            }
+        }
+
+        for (uint32_t t = 0; t < frames; ++t)
+            delayMix(fields, (float)(t + 1) * invFrames, fSplit[2 * band] + t * kLanes, fSplit[2 * band + 1] + t * kLanes,
+                     fReadL[t], fReadR[t], fWriteL[t], fWriteR[t], outL + t * kLanes, outR + t * kLanes);
+
+        for (uint32_t lane = 0; lane < lanes; ++lane)
+        {
+            float* const l = line(band, 0, first + lane);
+            float* const r = line(band, 1, first + lane);
+
+            write = (int32_t)fWriteIndex;
+            for (uint32_t t = 0; t < frames; ++t)
+            {
+                l[write] = fWriteL[t][lane];
+                r[write] = fWriteR[t][lane];
+
+                if (++write == length)
+                    write = 0;
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Kernels, one frame across the lanes of a group.
+    // Separate functions so the restrict parameters let the compiler vectorize.
+
+    /**
+       Crossover of one frame, also clears the output frame.
+       state is the group's first row, split the first of the six band rows, kMaxBlock frames apart.
+     */
+    static void splitFrame(const float* __restrict inL, const float* __restrict inR, float* __restrict state,
+                           float* __restrict split, float* __restrict outL, float* __restrict outR) noexcept
+    {
+        const uint32_t splitStride = kMaxBlock * kLanes;
+
+        for (uint32_t i = 0; i < kLanes; ++i)
+        {
+            const float a1 = state[kA1 * kLanes + i];
+            const float a2 = state[kA2 * kLanes + i];
+            const float a3 = state[kA3 * kLanes + i];
+            const float k = state[kK * kLanes + i];
+            const float ic1L = state[kIc1L * kLanes + i];
+            const float ic2L = state[kIc2L * kLanes + i];
+            const float ic1R = state[kIc1R * kLanes + i];
+            const float ic2R = state[kIc2R * kLanes + i];
+
+            const float v3L = inL[i] - ic2L;
+            const float v1L = a1 * ic1L + a2 * v3L;
+            const float v2L = ic2L + a2 * ic1L + a3 * v3L;
+            state[kIc1L * kLanes + i] = 2.0f * v1L - ic1L;
+            state[kIc2L * kLanes + i] = 2.0f * v2L - ic2L;
+
+            const float v3R = inR[i] - ic2R;
+            const float v1R = a1 * ic1R + a2 * v3R;
+            const float v2R = ic2R + a2 * ic1R + a3 * v3R;
+            state[kIc1R * kLanes + i] = 2.0f * v1R - ic1R;
+            state[kIc2R * kLanes + i] = 2.0f * v2R - ic2R;
+
+            split[(2 * kDL3YBandHigh) * splitStride + i] = inL[i] - k * v1L - v2L;
+            split[(2 * kDL3YBandHigh + 1) * splitStride + i] = inR[i] - k * v1R - v2R;
+            split[(2 * kDL3YBandMid) * splitStride + i] = k * v1L;
+            split[(2 * kDL3YBandMid + 1) * splitStride + i] = k * v1R;
+            split[(2 * kDL3YBandLow) * splitStride + i] = v2L;
+            split[(2 * kDL3YBandLow + 1) * splitStride + i] = v2R;
+
+            outL[i] = 0.0f;
+            outR[i] = 0.0f;
+        }
+    }
+
+    /**
+       Glide the delay times one frame, the read position and fractional part of each lane.
+     */
+    static void delayPositions(float* __restrict delay, const float* __restrict delayTarget, const float timeCoeff,
+                          const int32_t write, const int32_t length,
+                          int32_t* __restrict readIndex, float* __restrict frac) noexcept
+    {
+        for (uint32_t i = 0; i < kLanes; ++i)
+        {
+            const float d = delay[i] + (delayTarget[i] - delay[i]) * timeCoeff;
+            delay[i] = d;
+
+            const int32_t whole = (int32_t)d;
+            frac[i] = d - (float)whole;
+
+            const int32_t r0 = write - whole;
+            readIndex[i] = r0 < 0 ? r0 + length : r0;
+        }
+    }
+
+    /**
+       Compute the feedback writes from the delayed reads and sum the band into the output.
+       fields is the band's first row.
+     */
+    static void delayMix(const float* __restrict fields, const float ramp,
+                         const float* __restrict splitL, const float* __restrict splitR,
+                         const float* __restrict yL, const float* __restrict yR,
+                         float* __restrict writeL, float* __restrict writeR,
+                         float* __restrict outL, float* __restrict outR) noexcept
+    {
+        for (uint32_t i = 0; i < kLanes; ++i)
+        {
+            const float* const f = fields + i;
+            const float g = f[kGain * kLanes] + (f[(kRampTarget + kGain) * kLanes] - f[kGain * kLanes]) * ramp;
+            const float fb = f[kFeedback * kLanes] + (f[(kRampTarget + kFeedback) * kLanes] - f[kFeedback * kLanes]) * ramp;
+            const float cr = f[kCross * kLanes] + (f[(kRampTarget + kCross) * kLanes] - f[kCross * kLanes]) * ramp;
+            const float mx = f[kMix * kLanes] + (f[(kRampTarget + kMix) * kLanes] - f[kMix * kLanes]) * ramp;
+
+            const float xL = splitL[i] * g;
+            const float xR = splitR[i] * g;
+
+            writeL[i] = xL + fb * ((1.0f - cr) * yL[i] + cr * yR[i]);
+            writeR[i] = xR + fb * ((1.0f - cr) * yR[i] + cr * yL[i]);
+
+            outL[i] += (1.0f - mx) * xL + mx * yL[i];
+            outR[i] += (1.0f - mx) * xR + mx * yR[i];
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+
+    const uint32_t fNumInstances;
+    const uint32_t fNumGroups;
+    const double fSampleRate;
+    const DL3YCrossoverTable* const fCrossoverTable;
+    const uint32_t fLineLength;
+    const float fTimeCoeff;
+    uint32_t fWriteIndex;
+
+    // per instance
+    std::vector<float> fParameters;
+    std::vector<float> fBpm;
+    std::vector<uint8_t> fDirty;
+
+    // per group
+    std::vector<float> fState;
+    std::vector<float> fInput;
+    std::vector<float> fOutput;
+
+    // per instance, band and channel
+    std::vector<float> fLines;
+
+    // scratch for the group being processed
+    float fSplit[2 * kDL3YBandCount][kMaxBlock * kLanes];
+    int32_t fReadIndex[kMaxBlock][kLanes];
+    float fFrac[kMaxBlock][kLanes];
+    float fReadL[kMaxBlock][kLanes];
+    float fReadR[kMaxBlock][kLanes];
+    float fWriteL[kMaxBlock][kLanes];
+    float fWriteR[kMaxBlock][kLanes];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_BATCH_HPP_INCLUDED
@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_CONTROLS_HPP_INCLUDED
+#define DL3Y_CONTROLS_HPP_INCLUDED
+
+#include "DL3YCrossoverTable.hpp"
+#include "DL3YParameters.hpp"
+#include "DL3YPrimitives.hpp"
+
+#include <algorithm>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   DSP values of one band, the result of the band's parameter chains.
+ */
+struct DL3YBandValues {
+    float gain;
+    float feedback;
+    float cross;
+    float mix;
+    float delayFrames;
+};
+
+/**
+   Fold the parameter chains of one band into DSP values, constant folded:
+   amount -> gain, "/ 100" for feedback, cross and mix, and the time / sync / timesync / bpm chain
+   with its "min 5000" into a delay length in frames.
+   parameters holds all kDL3YParameterCount values of one instance, beatMs is dl3yBeatMs() of its tempo.
+ */
+static inline DL3YBandValues dl3yFoldBand(const float* const parameters, const uint32_t band, const float beatMs,
+                                          const double sampleRate) noexcept
+{
+    const DL3YBandParameters& p(kDL3YBandParameters[band]);
+    const float timeMs = dl3yBandTimeMs(parameters[p.time], parameters[p.sync] > 0.5f, parameters[p.timeSync], beatMs);
+
+    DL3YBandValues v;
+    v.gain = dl3yBandGain(parameters[p.amount]);
+    v.feedback = dl3yPercent(parameters[p.feedback]);
+    v.cross = dl3yPercent(parameters[p.cross]);
+    v.mix = dl3yPercent(parameters[p.mix]);
+    v.delayFrames = (float)(timeMs * 0.001 * sampleRate);
+    return v;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   A value ramped linearly over one block: value + step * (t + 1) at frame t, target after the block.
+ */
+struct DL3YRamp {
+    float value;
+    float step;
+    float target;
+
+    void reset(const float v) noexcept
+    {
+        value = target = v;
+        step = 0.0f;
+    }
+
+    void prepare(const float newTarget, const float invFrames) noexcept
+    {
+        value = target;
+        target = newTarget;
+        step = (target - value) * invFrames;
+    }
+};
+
+/**
+   The parameters and host tempo of one DL3Y instance, bound straight to DSP values.
+
+   setParameter() and setBpm() only store the value and flag it. Once per block prepare() folds the
+   flagged parameters into targets (only the bands and crossover that changed) and sets up the block's
+   linear ramps, so automation costs the same per block no matter how many parameters or messages
+   arrived. The beat length is computed once per tempo change and shared by the three bands.
+   Delay lengths are not ramped here, the engine moves them itself, see tempoChanged().
+ */
+class DL3YControls
+{
+public:
+    explicit DL3YControls(const double sampleRate) noexcept
+        : fSampleRate(sampleRate),
+          fCrossoverTable(nullptr),
+          fBpm(kDL3YDefaultBpm),
+          fBeatMs(dl3yBeatMs(kDL3YDefaultBpm)),
+          fDirty(kAllDirty),
+          fTempoChanged(0)
+    {
+        for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+            fParameters[p] = kDL3YParameterRanges[p].def;
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            fGain[b].reset(0.0f);
+            fFeedback[b].reset(0.0f);
+            fCross[b].reset(0.0f);
+            fMix[b].reset(0.0f);
+        }
+
+        // start settled on the defaults, no ramp on the first block
+        prepare(1);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            fGain[b].reset(fGain[b].target);
+            fFeedback[b].reset(fFeedback[b].target);
+            fCross[b].reset(fCross[b].target);
+            fMix[b].reset(fMix[b].target);
+        }
+    }
+
+    void setSampleRate(const double sampleRate) noexcept
+    {
+        fSampleRate = sampleRate;
+        fDirty = kAllDirty;
+    }
+
+    double getSampleRate() const noexcept { return fSampleRate; }
+
+    /**
+       Read the crossover coefficients from table while it is for the current sample rate, they are
+       computed directly otherwise.
+     */
+    void setCrossoverTable(const DL3YCrossoverTable* const table) noexcept
+    {
+        if (fCrossoverTable == table)
+            return;
+
+        fCrossoverTable = table;
+        fDirty |= 1u << kDL3YMid_Freq;
+    }
+
+    float getParameter(const uint32_t index) const noexcept
+    {
+        return index < kDL3YParameterCount ? fParameters[index] : 0.0f;
+    }
+
+    const float* getParameters() const noexcept { return fParameters; }
+
+    void setParameter(const uint32_t index, const float value) noexcept
+    {
+        if (index >= kDL3YParameterCount)
+            return;
+
+        const DL3YParameterRange& range(kDL3YParameterRanges[index]);
+        const float clamped = std::max(range.min, std::min(range.max, value));
+
+        if (fParameters[index] == clamped)
+            return;
+
+        fParameters[index] = clamped;
+        fDirty |= 1u << index;
+    }
+
+    float getBpm() const noexcept { return fBpm; }
+
+    void setBpm(const float bpm) noexcept
+    {
+        if (bpm <= 0.0f || fBpm == bpm)
+            return;
+
+        fBpm = bpm;
+        fDirty |= kBpmDirty;
+    }
+
+    /**
+       Fold the changed parameters and start the ramps of the next block of frames.
+       Returns true when the crossover coefficients changed.
+     */
+    bool prepare(const uint32_t frames) noexcept
+    {
+        const float invFrames = 1.0f / (float)std::max(frames, 1u);
+        const uint32_t dirty = fDirty;
+        fDirty = 0;
+        fTempoChanged = 0;
+
+        if (dirty & kBpmDirty)
+            fBeatMs = dl3yBeatMs(fBpm);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            if (dirty & bandMask(b))
+            {
+                const bool tempoOnly = (dirty & bandMask(b)) == kBpmDirty;
+                const float delayFrames = tempoOnly ? fBand[b].delayFrames : 0.0f;
+
+                fBand[b] = dl3yFoldBand(fParameters, b, fBeatMs, fSampleRate);
+
+                if (tempoOnly && fBand[b].delayFrames != delayFrames)
+                    fTempoChanged |= 1u << b;
+            }
+
+            fGain[b].prepare(fBand[b].gain, invFrames);
+            fFeedback[b].prepare(fBand[b].feedback, invFrames);
+            fCross[b].prepare(fBand[b].cross, invFrames);
+            fMix[b].prepare(fBand[b].mix, invFrames);
+        }
+
+        if (dirty & (1u << kDL3YMid_Freq | kRateDirty))
+        {
+            if (fCrossoverTable != nullptr && fCrossoverTable->getSampleRate() == fSampleRate)
+                fCrossover = fCrossoverTable->lookup(fParameters[kDL3YMid_Freq]);
+            else
+                fCrossover = dl3yCrossoverCoeffs(fParameters[kDL3YMid_Freq], fSampleRate);
+            return true;
+        }
+
+        return false;
+    }
+
+    const DL3YRamp& gain(const uint32_t band) const noexcept { return fGain[band]; }
+    const DL3YRamp& feedback(const uint32_t band) const noexcept { return fFeedback[band]; }
+    const DL3YRamp& cross(const uint32_t band) const noexcept { return fCross[band]; }
+    const DL3YRamp& mix(const uint32_t band) const noexcept { return fMix[band]; }
+    float delayFrames(const uint32_t band) const noexcept { return fBand[band].delayFrames; }
+
+    /**
+       True when the band's delay length changed in the last prepare() because of the host tempo alone,
+       as with tempo automation, which the engine follows sample by sample over the block.
+     */
+    bool tempoChanged(const uint32_t band) const noexcept { return (fTempoChanged >> band) & 1u; }
+    const DL3YCrossoverCoeffs& crossover() const noexcept { return fCrossover; }
+
+private:
+    static const uint32_t kBpmDirty = 1u << kDL3YParameterCount;
+    static const uint32_t kRateDirty = 1u << (kDL3YParameterCount + 1);
+    static const uint32_t kAllDirty = (kRateDirty << 1) - 1;
+
+    // parameters of a band, plus tempo and sample rate that every band's delay length depends on
+    static uint32_t bandMask(const uint32_t band) noexcept
+    {
+        const DL3YBandParameters& p(kDL3YBandParameters[band]);
+        return 1u << p.amount | 1u << p.cross | 1u << p.feedback | 1u << p.mix
+             | 1u << p.sync | 1u << p.time | 1u << p.timeSync | kBpmDirty | kRateDirty;
+    }
+
+    double fSampleRate;
+    const DL3YCrossoverTable* fCrossoverTable;
+    float fBpm;
+    float fBeatMs;
+    uint32_t fDirty;
+    uint32_t fTempoChanged;
+    float fParameters[kDL3YParameterCount];
+
+    DL3YBandValues fBand[kDL3YBandCount];
+    DL3YRamp fGain[kDL3YBandCount];
+    DL3YRamp fFeedback[kDL3YBandCount];
+    DL3YRamp fCross[kDL3YBandCount];
+    DL3YRamp fMix[kDL3YBandCount];
+    DL3YCrossoverCoeffs fCrossover;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_CONTROLS_HPP_INCLUDED
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_CROSSOVER_TABLE_HPP_INCLUDED
+#define DL3Y_CROSSOVER_TABLE_HPP_INCLUDED
+
+#include "DL3YParameters.hpp"
+#include "DL3YPrimitives.hpp"
+
+#include <cmath>
+#include <mutex>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Crossover coefficients over the Mid_Freq range at one sample rate, so sweeping the split costs a
+   table read instead of three tan() calls and the mid Q chain.
+
+   Entries are spaced evenly within each octave, kStepsPerOctave of them, so the spacing follows the
+   log frequency scale of the parameter while the octave and the position in it come straight from
+   the float's exponent and mantissa (frexp). Coefficients are interpolated linearly between entries,
+   within 1e-6 of dl3yCrossoverCoeffs() over most of the range and 2e-4 in the steps holding the
+   corners of the mid Q curve (dl3yMidBandwidth()).
+
+   Tables are built once per sample rate and shared read-only by every engine in the process, see
+   dl3yCrossoverTable().
+ */
+class DL3YCrossoverTable
+{
+public:
+    static const uint32_t kStepsPerOctave = 128;
+
+    explicit DL3YCrossoverTable(const double sampleRate) noexcept
+        : fSampleRate(sampleRate)
+    {
+        for (uint32_t i = 0; i <= kSize; ++i)
+        {
+            const int octave = (int)(i / kStepsPerOctave);
+            const double mantissa = 1.0 + (double)(i % kStepsPerOctave) / kStepsPerOctave;
+
+            fEntries[i] = dl3yCrossoverCoeffs((float)std::ldexp(mantissa, kFirstOctave + octave), sampleRate);
+        }
+    }
+
+    double getSampleRate() const noexcept { return fSampleRate; }
+
+    /**
+       Coefficients at freq, clamped to the Mid_Freq range.
+     */
+    DL3YCrossoverCoeffs lookup(const float freq) const noexcept
+    {
+        const DL3YParameterRange& range(kDL3YParameterRanges[kDL3YMid_Freq]);
+        int exponent;
+
+        // freq = m * 2^exponent with m in [0.5, 1)
+        const float m = std::frexp(std::max(range.min, std::min(range.max, freq)), &exponent);
+        const float position = (m * 2.0f - 1.0f) * kStepsPerOctave;
+        const uint32_t step = (uint32_t)position;
+        const uint32_t i = (uint32_t)(exponent - 1 - kFirstOctave) * kStepsPerOctave + step;
+        const float t = position - (float)step;
+
+        const DL3YCrossoverCoeffs& c0(fEntries[i]);
+        const DL3YCrossoverCoeffs& c1(fEntries[i + 1]);
+        DL3YCrossoverCoeffs c;
+        c.a1 = dl3yLinear(c0.a1, c1.a1, t);
+        c.a2 = dl3yLinear(c0.a2, c1.a2, t);
+        c.a3 = dl3yLinear(c0.a3, c1.a3, t);
+        c.k = dl3yLinear(c0.k, c1.k, t);
+        c.g1 = dl3yLinear(c0.g1, c1.g1, t);
+        c.g2 = dl3yLinear(c0.g2, c1.g2, t);
+        return c;
+    }
+
+private:
+    // octaves 2^8 = 256 Hz up to 2^13 = 8192 Hz hold the 313.3 - 5705.6 Hz range
+    static const int kFirstOctave = 8;
+    static const uint32_t kSize = 5 * kStepsPerOctave;
+
+    const double fSampleRate;
+    DL3YCrossoverCoeffs fEntries[kSize + 1];
+};
+
+/**
+   The process-wide table for sampleRate, built on first use and kept until the process exits.
+   Takes a lock and may compute a table, so not realtime safe; engines fetch it along with their
+   delay lines, see DL3YLineBuffer. Returns nullptr once kMaxRates different rates are in use, callers
+   then compute the coefficients directly.
+   Not static, so every translation unit shares the same tables.
+ */
+inline const DL3YCrossoverTable* dl3yCrossoverTable(const double sampleRate)
+{
+    static const uint32_t kMaxRates = 16;
+    static std::mutex mutex;
+    static const DL3YCrossoverTable* tables[kMaxRates] = {};
+
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    for (uint32_t i = 0; i < kMaxRates; ++i)
+    {
+        if (tables[i] == nullptr)
+            return tables[i] = new DL3YCrossoverTable(sampleRate);
+
+        if (tables[i]->getSampleRate() == sampleRate)
+            return tables[i];
+    }
+
+    return nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_CROSSOVER_TABLE_HPP_INCLUDED
@@ -0,0 +1,1534 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_ENGINE_HPP_INCLUDED
+#define DL3Y_ENGINE_HPP_INCLUDED
+
+#include "DL3YControls.hpp"
+#include "DL3YLines.hpp"
+#include "DL3YLoadMeter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// the stereo crossover runs both channels in one SSE vector, which every x86_64 target has
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+# define DL3Y_SSE_SPLIT 1
+# include <xmmintrin.h>
+#else
+# define DL3Y_SSE_SPLIT 0
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Delay line interpolation of each quality, p points at the tap at the whole delay (x0), older taps
+   are at negative offsets. kNewer and kOlder are the extra taps read on each side.
+ */
+template <uint32_t kQuality>
+struct DL3YInterpolator;
+
+template <>
+struct DL3YInterpolator<kDL3YQualityEco> {
+    static const int32_t kNewer = 0, kOlder = 1;
+
+    static float read(const float* const p, const float t) noexcept
+    {
+        return dl3yLinear(p[0], p[-1], t);
+    }
+};
+
+template <>
+struct DL3YInterpolator<kDL3YQualityNormal> {
+    static const int32_t kNewer = 1, kOlder = 2;
+
+    static float read(const float* const p, const float t) noexcept
+    {
+        return dl3yHermite(p[1], p[0], p[-1], p[-2], t);
+    }
+};
+
+template <>
+struct DL3YInterpolator<kDL3YQualityHigh> {
+    static const int32_t kNewer = 2, kOlder = 3;
+
+    static float read(const float* const p, const float t) noexcept
+    {
+        return dl3yLagrange6(p[2], p[1], p[0], p[-1], p[-2], p[-3], t);
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Hand-written DSP for the WSTD_DL3Y graph: adc~ -> stereo_eq_pass -> 3x dlay -> dac~.
+
+   Host blocks are processed in chunks of at most kMaxChunk frames:
+    - the crossover writes each band's input straight into the band's chunk buffer
+    - every band runs a kernel specialized at compile time on quality, band enabled / disabled,
+      delay time static / gliding, first band / accumulating and the host sample type, picked per
+      chunk from a table, and mixes its output straight into the host output buffer
+
+   The Quality parameter trades CPU for quality, see DL3YQuality. Normal matches the graph.
+
+   At 88.2 kHz and above the low band runs decimated (see dl3yLowBandDecimation()): its input is
+   decimated with a polyphase filter, delayed and fed back at the lower rate in shorter lines, and
+   interpolated back for the mix, see processDecimatedBand().
+
+   Mono sources sent to both inputs run a single channel path: while the two input channels of a
+   chunk agree within kDL3YMonoThreshold, and so do the crossover states and everything the bands can
+   still read from their lines, only the left channel is split, delayed and mixed, and the result is
+   copied to the right output. The right lines keep getting the same writes, so when the inputs
+   diverge again stereo processing resumes from the state it would have had all along.
+
+   Delay time changes glide towards the new length over kDL3YTimeSmoothingSeconds. Tempo changes of
+   synced bands, as from tempo automation, instead ramp linearly from the first to the last frame of
+   the host block that reported them, so a tempo ramp moves the delays sample by sample and lands on
+   the host's tempo at each block boundary, see DL3YControls::tempoChanged(). A parameter snapshot
+   (loadSnapshot(), for states and presets) crossfades from the old tap to the new one instead,
+   on the same lines, so a scene change neither sweeps the pitch nor clicks.
+
+   The shortest delay (50 ms) is longer than a chunk, so a chunk never reads what it writes: the
+   delayed reads of a whole chunk are done first, which with a static delay time is a plain
+   vectorizable loop over consecutive frames, then the feedback is mixed and written back.
+
+   The delay lines can follow a sample rate change without allocating on the audio thread:
+   changeSampleRate() fades out what the lines hold, lines for the new rate are prepared elsewhere
+   (see DL3YLineWorker) and handed over with setLines(), and the engine swaps them in at the start
+   of a block once the fade is done. setSampleRate() does all of it at once, for offline use.
+
+   Parameter semantics are those of the @hv_param receivers, see DL3YControls.
+   The caller should run process() with denormals flushed to zero. Where that cannot be done
+   (WebAssembly), build with DL3Y_FLUSH_DENORMALS=1: the crossover state and the feedback writes are
+   then flushed by hand, which is all the recursion there is, so silence decays to zeros.
+ */
+class DL3YEngine
+{
+public:
+    static const uint32_t kMaxChunk = 256;
+
+    explicit DL3YEngine(const double sampleRate)
+        : fControls(sampleRate),
+          fQuality(kDL3YQualityNormal),
+          fMonoDetection(true),
+          fLines(nullptr),
+          fIncomingLines(nullptr),
+          fRetiredLines(nullptr),
+          fLineLength(0),
+          fWriteIndex(0),
+          fLinesStale(false),
+          fFade(1.0f),
+          fFadeStep(0.0f),
+          fRise(1.0f),
+          fSnapshotPending(false)
+#if DL3Y_LOAD_METER
+        , fLoadMeter(nullptr)
+#endif
+    {
+        setSampleRate(sampleRate);
+    }
+
+    ~DL3YEngine()
+    {
+        delete fLines;
+        delete fIncomingLines;
+        delete fRetiredLines;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Parameters
+
+    float getParameter(const uint32_t index) const noexcept { return fControls.getParameter(index); }
+    void setBpm(const float bpm) noexcept { fControls.setBpm(bpm); }
+
+    void setParameter(const uint32_t index, const float value) noexcept
+    {
+        fControls.setParameter(index, value);
+
+        // a later single change must not be undone by a waiting snapshot
+        if (fSnapshotPending && index < kDL3YParameterCount)
+            fSnapshot[index] = value;
+    }
+
+    /**
+       Apply all kDL3YParameterCount parameter values at once at the start of the next block, as when
+       a state or preset is loaded. Bands whose delay time changes crossfade from the old tap to the new
+       one over kDL3YTapFadeSeconds instead of gliding, all other values ramp over that block.
+       A snapshot that arrives while such a crossfade runs waits for it to end.
+       Realtime safe, the delay lines are neither reallocated nor cleared.
+     */
+    void loadSnapshot(const float* const parameters) noexcept
+    {
+        std::memcpy(fSnapshot, parameters, sizeof(fSnapshot));
+        fSnapshotPending = true;
+    }
+
+    double getSampleRate() const noexcept { return fControls.getSampleRate(); }
+
+    /**
+       Allow the single channel path for mono input, on by default. Off always processes both channels,
+       for comparing the two.
+     */
+    void setMonoDetection(const bool enabled) noexcept { fMonoDetection = enabled; }
+
+#if DL3Y_LOAD_METER
+    /**
+       Time the crossover and each band into meter, which the caller begins and ends around process().
+     */
+    void setLoadMeter(DL3YLoadMeter* const meter) noexcept { fLoadMeter = meter; }
+#endif
+
+    /**
+       Resize the delay lines for a new sample rate, also clears them.
+       Not realtime safe.
+     */
+    void setSampleRate(const double sampleRate)
+    {
+        DL3YLineBuffer* const lines = new DL3YLineBuffer(sampleRate);
+
+        delete fLines;
+        delete fIncomingLines;
+        delete fRetiredLines;
+        fIncomingLines = fRetiredLines = nullptr;
+
+        changeSampleRate(sampleRate);
+        swapLines(lines);
+        fRise = 1.0f;
+        reset();
+    }
+
+    /**
+       Follow a new sample rate without touching the delay line storage, for hosts that change it while
+       others keep playing. Coefficients and delay times follow at once; if the lines have the wrong
+       length, the delayed signal fades out over kDL3YLineFadeSeconds and stays silent until lines for
+       the new rate are handed over with setLines().
+       Does not allocate, but must not run concurrently with process().
+     */
+    void changeSampleRate(const double sampleRate) noexcept
+    {
+        fControls.setSampleRate(sampleRate);
+        fTimeCoeff = (float)(1.0 - std::exp(-1.0 / (kDL3YTimeSmoothingSeconds * sampleRate)));
+        fTapFadeStep = (float)(1.0 / (kDL3YTapFadeSeconds * sampleRate));
+
+        fControls.prepare(1);
+        fCoeffs = fControls.crossover();
+
+        // old content is at the old rate, the delays glide to their new lengths while it fades out
+        fLinesStale = fLines == nullptr || fLines->length != dl3yLineLength(sampleRate);
+        fFadeStep = (float)(1.0 / (kDL3YLineFadeSeconds * sampleRate));
+        if (! fLinesStale)
+            fFade = 1.0f;
+    }
+
+    /**
+       True while the engine waits for lines of the current sample rate.
+     */
+    bool needsLines() const noexcept
+    {
+        return fLinesStale && fIncomingLines == nullptr;
+    }
+
+    /**
+       Hand over lines for the current sample rate, swapped in at the start of a block once the old
+       content has faded out. Returns false, keeping the lines with the caller, when they do not fit
+       the current sample rate or other lines are already waiting.
+       Realtime safe.
+     */
+    bool setLines(DL3YLineBuffer* const lines) noexcept
+    {
+        if (fIncomingLines != nullptr || ! fLinesStale || lines->length != dl3yLineLength(getSampleRate()))
+            return false;
+
+        fIncomingLines = lines;
+        return true;
+    }
+
+    /**
+       Lines replaced by setLines(), for the caller to free off the audio thread.
+       Realtime safe.
+     */
+    DL3YLineBuffer* takeRetiredLines() noexcept
+    {
+        DL3YLineBuffer* const lines = fRetiredLines;
+        fRetiredLines = nullptr;
+        return lines;
+    }
+
+    /**
+       Clear the delay lines and filter states, parameters are kept.
+     */
+    void reset() noexcept
+    {
+        std::memset(fLines->data, 0, fLines->size * sizeof(float));
+        std::memset(fState, 0, sizeof(fState));
+        fResampler.reset();
+        fWriteIndex = 0;
+        fLowWriteIndex = 0;
+
+        // cleared lines are the same on both channels, and quiet
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            fMonoFrames[b] = fLineLength;
+            fQuietFrames[b] = fLines->bandLength[b];
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Process
+
+    /**
+       Process a stereo block, inputs and outputs may be the same buffers.
+       T is the host sample type, float or double.
+     */
+    template <typename T>
+    void process(const T* const* const inputs, T* const* const outputs, const uint32_t frames) noexcept
+    {
+        const bool snapshot = fSnapshotPending && ! tapsFading();
+
+        if (snapshot)
+        {
+            for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+                fControls.setParameter(p, fSnapshot[p]);
+            fSnapshotPending = false;
+        }
+
+        if (fControls.prepare(frames))
+            fCoeffs = fControls.crossover();
+
+        // gentle tempo changes ramp over this block, steeper ones and stale lines keep the glide
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            fDelayStep[b] = 0.0f;
+
+            if (fControls.tempoChanged(b) && ! fLinesStale && fTapFade[b] >= 1.0f)
+            {
+                const float step = (targetDelay(b) - fDelay[b]) / (float)std::max(frames, 1u);
+
+                if (std::fabs(step) <= kDL3YTempoRampSlope)
+                    fDelayStep[b] = step;
+            }
+        }
+
+        // new lines wait while the previous retired ones were not taken yet
+        if (fIncomingLines != nullptr && fRetiredLines == nullptr)
+        {
+            if (fIncomingLines->length != dl3yLineLength(getSampleRate()))
+            {
+                // prepared for a sample rate that did not last
+                fRetiredLines = fIncomingLines;
+                fIncomingLines = nullptr;
+            }
+            else if (fFade <= 0.0f)
+            {
+                fRetiredLines = fLines;
+                swapLines(fIncomingLines);
+                fIncomingLines = nullptr;
+            }
+        }
+
+        if (snapshot && ! fLinesStale)
+            startTapFades();
+
+        // the first order and state variable splits keep different states, the next chunk crossfades
+        // from the old split to the new one
+        const DL3YQuality quality = dl3yQuality(fControls.getParameter(kDL3YQuality));
+        const bool splitChanged = (quality == kDL3YQualityEco) != (fQuality == kDL3YQualityEco);
+        fQuality = quality;
+
+        for (uint32_t offset = 0; offset < frames;)
+        {
+            const uint32_t n = frames - offset < kMaxChunk ? frames - offset : kMaxChunk;
+            const bool monoInput = fMonoDetection && dl3ySameSignal(inputs[0] + offset, inputs[1] + offset, n);
+            const bool mono = monoInput && monoReady();
+
+            if (splitChanged && offset == 0)
+                crossfadeSplits(quality == kDL3YQualityEco, mono, inputs[0] + offset, inputs[1] + offset, n);
+            else
+                splitChunk(quality == kDL3YQualityEco, mono, inputs[0] + offset, inputs[1] + offset, n);
+#if DL3Y_FLUSH_DENORMALS
+            dl3yFlushDenormals(fState, 4);
+#endif
+            markLoad(kDL3YStageCrossover);
+
+            // the first band processed writes the output, the others add to it
+            bool accumulate = false;
+
+            for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+            {
+                const DL3YRamp& gain(fControls.gain(b));
+                const bool enabled = gain.value != 0.0f || gain.target != 0.0f;
+
+                // a disabled band whose lines only hold a decayed tail adds nothing and only writes that
+                // tail back, it is skipped until it is enabled again; its lines stay quiet on both channels
+                if (! enabled && fQuietFrames[b] >= fLines->bandLength[b])
+                {
+                    fDelay[b] = targetDelay(b);
+                    fTapFade[b] = 1.0f;
+                    fMonoFrames[b] = fLineLength;
+                    markLoad((DL3YLoadStage)(kDL3YStageHigh + b));
+                    continue;
+                }
+
+                // stale lines are read at a fixed delay while they fade out, a glide would sweep their pitch;
+                // changes during a tap crossfade glide once it is done
+                const bool gliding = ! fLinesStale && fTapFade[b] >= 1.0f && updateGlide(b);
+
+                if (b == kDL3YBandLow && fResampler.getDecimation() > 1)
+                {
+                    if (! accumulate)
+                        clearOutputs(outputs, offset, n, mono);
+                    (this->*DecimatedKernels<T>::table[quality][mono][gliding])(b, offset, n, outputs[0] + offset, outputs[1] + offset);
+                }
+                else
+                {
+                    (this->*BandKernels<T>::table[quality][mono][enabled][gliding][accumulate])(b, offset, n, outputs[0] + offset, outputs[1] + offset);
+                }
+                accumulate = true;
+
+                // frames of the same writes on both lines, stereo input invalidates them
+                if (monoInput && (mono || dl3ySameSignal(fWriteL, fWriteR, fWritten)))
+                    fMonoFrames[b] = fMonoFrames[b] + n < fLineLength ? fMonoFrames[b] + n : fLineLength;
+                else
+                    fMonoFrames[b] = 0;
+
+                // frames of quiet writes in a row, counted while the band is disabled
+                if (! enabled && dl3yQuiet(fWriteL, fWritten) && (mono || dl3yQuiet(fWriteR, fWritten)))
+                    fQuietFrames[b] += fWritten;
+                else
+                    fQuietFrames[b] = 0;
+
+                markLoad((DL3YLoadStage)(kDL3YStageHigh + b));
+            }
+
+            if (! accumulate)
+                clearOutputs(outputs, offset, n, mono);
+
+            if (mono)
+                std::memmove(outputs[1] + offset, outputs[0] + offset, n * sizeof(T));
+
+            if (fLinesStale)
+                fFade = std::max(0.0f, fFade - fFadeStep * (float)n);
+            if (fRise < 1.0f)
+                fRise = std::min(1.0f, fRise + fFadeStep * (float)n);
+
+            fWriteIndex += n;
+            if (fWriteIndex >= fLineLength)
+                fWriteIndex -= fLineLength;
+
+            offset += n;
+        }
+
+        // ramps end on their target, without the rounding of frames steps
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            if (fDelayStep[b] != 0.0f)
+                fDelay[b] = targetDelay(b);
+        }
+    }
+
+private:
+    void markLoad(const DL3YLoadStage stage) noexcept
+    {
+#if DL3Y_LOAD_METER
+        if (fLoadMeter != nullptr)
+            fLoadMeter->mark(stage);
+#else
+        (void)stage;
+#endif
+    }
+
+    /**
+       Start using lines of the current sample rate, their content is silent so the delay times jump
+       straight to their targets. What is written into them fades in, so the first echoes do not
+       start with a step.
+     */
+    void swapLines(DL3YLineBuffer* const lines) noexcept
+    {
+        fLines = lines;
+        fLineLength = lines->length;
+        fWriteIndex = 0;
+        fLowWriteIndex = 0;
+
+        // Mid_Freq changes read the coefficients from the table that came with the lines
+        fControls.setCrossoverTable(lines->crossover);
+
+        // the low band lines are at the decimated rate, the delays short enough that no chunk reads what it writes
+        fResampler.setDecimation(lines->decimation);
+        fLowTimeCoeff = 1.0f - std::pow(1.0f - fTimeCoeff, (float)lines->decimation);
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+            fShortestDelay[b] = (float)(kMaxChunk + kDL3YLineGuard);
+        if (lines->decimation > 1)
+            fShortestDelay[kDL3YBandLow] = (float)(kMaxChunk + fResampler.getLatency() + (kDL3YLineGuard + 1) * lines->decimation);
+        fLinesStale = false;
+        fFade = 1.0f;
+        fRise = 0.0f;
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            fDelay[b] = targetDelay(b);
+            fDelayStep[b] = 0.0f;
+            fTapFade[b] = 1.0f;
+            fMonoFrames[b] = fLineLength;
+            fQuietFrames[b] = lines->bandLength[b];
+        }
+    }
+
+    /**
+       The fade of stale lines on the delayed reads of one chunk.
+     */
+    void fadeReads(const uint32_t frames, const bool mono) noexcept
+    {
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float g = std::max(0.0f, fFade - fFadeStep * (float)(t + 1));
+
+            fReadL[t] *= g;
+            if (! mono)
+                fReadR[t] *= g;
+        }
+    }
+
+    /**
+       The fade in on the writes of one chunk into swapped in lines. They are silent for longer than
+       the fade, so the writes are just the band input.
+     */
+    void riseWrites(const uint32_t frames, const bool mono) noexcept
+    {
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float g = std::min(1.0f, fRise + fFadeStep * (float)(t + 1));
+
+            fWriteL[t] *= g;
+            if (! mono)
+                fWriteR[t] *= g;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Snapshots
+
+    bool tapsFading() const noexcept
+    {
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            if (fTapFade[b] < 1.0f)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+       Move each band whose delay time the snapshot changed straight to its target, fading in the new tap
+       while the old one, read from the same line, fades out.
+     */
+    void startTapFades() noexcept
+    {
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            const float target = targetDelay(b);
+
+            if (std::fabs(fDelay[b] - target) < 1e-3f)
+                continue;
+
+            fFadeFromDelay[b] = fDelay[b];
+            fDelay[b] = target;
+            fDelayStep[b] = 0.0f;
+            fTapFade[b] = 0.0f;
+        }
+    }
+
+    /**
+       The tap crossfade on the delayed reads of one chunk: reads the old tap and blends from it into
+       the new reads already in fReadL / fReadR.
+     */
+    template <uint32_t kQuality, bool kMono>
+    void crossfadeTaps(const uint32_t band, const float* const lineL, const float* const lineR, const uint32_t frames) noexcept
+    {
+        const int32_t whole = (int32_t)fFadeFromDelay[band];
+        const float frac = fFadeFromDelay[band] - (float)whole;
+        const int32_t start = (int32_t)fWriteIndex - whole;
+        const float g0 = fTapFade[band], gs = fTapFadeStep;
+
+        readStatic<kQuality>(lineL, start, (int32_t)fLineLength, frac, fOldReadL, frames);
+        if (!kMono)
+            readStatic<kQuality>(lineR, start, (int32_t)fLineLength, frac, fOldReadR, frames);
+
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float g = std::min(1.0f, g0 + gs * (float)(t + 1));
+
+            fReadL[t] = fOldReadL[t] + (fReadL[t] - fOldReadL[t]) * g;
+            if (!kMono)
+                fReadR[t] = fOldReadR[t] + (fReadR[t] - fOldReadR[t]) * g;
+        }
+
+        fTapFade[band] = std::min(1.0f, g0 + gs * (float)frames);
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Mono
+
+    /**
+       Returns true when both channels of every band will read the same delayed signal in the next chunk,
+       and syncs the right crossover state to the left one, which differs by at most kDL3YMonoThreshold.
+       Gliding bands need the matching writes to reach back to the longer of their current and target delay.
+     */
+    bool monoReady() noexcept
+    {
+        if (std::fabs(fState[0] - fState[2]) > kDL3YMonoThreshold || std::fabs(fState[1] - fState[3]) > kDL3YMonoThreshold)
+            return false;
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            const float from = fTapFade[b] < 1.0f ? fFadeFromDelay[b] : fDelay[b];
+            float reach = std::ceil(std::max(std::max(fDelay[b], from), targetDelay(b))) + (float)kDL3YLineGuard;
+
+            // the decimated low band also reads its guard at the lower rate, and has the resampler history
+            if (b == kDL3YBandLow && fResampler.getDecimation() > 1)
+                reach += (float)(fResampler.getLatency() + (kDL3YLineGuard + kDL3YResamplerTaps) * fResampler.getDecimation());
+
+            if ((float)fMonoFrames[b] < reach)
+                return false;
+        }
+
+        fState[2] = fState[0];
+        fState[3] = fState[1];
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Crossover
+
+    /**
+       Split of one chunk into the six band buffers, with the state variable filter or, for Eco,
+       the two one-poles at the band edges. kMono splits the left channel only.
+     */
+    template <bool kFirstOrder, bool kMono, typename T>
+    void split(const T* const inL, const T* const inR, const uint32_t frames) noexcept
+    {
+        float* const __restrict highL = fSplit[2 * kDL3YBandHigh];
+        float* const __restrict highR = fSplit[2 * kDL3YBandHigh + 1];
+        float* const __restrict midL = fSplit[2 * kDL3YBandMid];
+        float* const __restrict midR = fSplit[2 * kDL3YBandMid + 1];
+        float* const __restrict lowL = fSplit[2 * kDL3YBandLow];
+        float* const __restrict lowR = fSplit[2 * kDL3YBandLow + 1];
+
+        // stereo frames already split by the lane-parallel kernel, the loops below do the rest
+        const uint32_t done = kMono ? 0 : splitStereoSse<kFirstOrder>(inL, inR, frames);
+
+        if (kFirstOrder)
+        {
+            const float g1 = fCoeffs.g1, g2 = fCoeffs.g2;
+            float s1L = fState[0], s2L = fState[1], s1R = fState[2], s2R = fState[3];
+
+            if (kMono)
+            {
+                for (uint32_t t = 0; t < frames; ++t)
+                {
+                    const float xL = (float)inL[t];
+
+                    const float v1L = (xL - s1L) * g1, lp1L = v1L + s1L;
+                    const float v2L = (xL - s2L) * g2, lp2L = v2L + s2L;
+                    s1L = lp1L + v1L; s2L = lp2L + v2L;
+
+                    highL[t] = xL - lp2L;
+                    midL[t] = lp2L - lp1L;
+                    lowL[t] = lp1L;
+                }
+
+                fState[0] = fState[2] = s1L; fState[1] = fState[3] = s2L;
+                return;
+            }
+
+            for (uint32_t t = done; t < frames; ++t)
+            {
+                const float xL = (float)inL[t];
+                const float xR = (float)inR[t];
+
+                const float v1L = (xL - s1L) * g1, lp1L = v1L + s1L;
+                const float v2L = (xL - s2L) * g2, lp2L = v2L + s2L;
+                const float v1R = (xR - s1R) * g1, lp1R = v1R + s1R;
+                const float v2R = (xR - s2R) * g2, lp2R = v2R + s2R;
+                s1L = lp1L + v1L; s2L = lp2L + v2L;
+                s1R = lp1R + v1R; s2R = lp2R + v2R;
+
+                highL[t] = xL - lp2L;
+                highR[t] = xR - lp2R;
+                midL[t] = lp2L - lp1L;
+                midR[t] = lp2R - lp1R;
+                lowL[t] = lp1L;
+                lowR[t] = lp1R;
+            }
+
+            fState[0] = s1L; fState[1] = s2L; fState[2] = s1R; fState[3] = s2R;
+            return;
+        }
+
+        const float a1 = fCoeffs.a1, a2 = fCoeffs.a2, a3 = fCoeffs.a3, k = fCoeffs.k;
+        float ic1L = fState[0], ic2L = fState[1], ic1R = fState[2], ic2R = fState[3];
+
+        if (kMono)
+        {
+            for (uint32_t t = 0; t < frames; ++t)
+            {
+                const float xL = (float)inL[t];
+
+                const float v3L = xL - ic2L;
+                const float v1L = a1 * ic1L + a2 * v3L;
+                const float v2L = ic2L + a2 * ic1L + a3 * v3L;
+                ic1L = 2.0f * v1L - ic1L;
+                ic2L = 2.0f * v2L - ic2L;
+
+                highL[t] = xL - k * v1L - v2L;
+                midL[t] = k * v1L;
+                lowL[t] = v2L;
+            }
+
+            fState[0] = fState[2] = ic1L; fState[1] = fState[3] = ic2L;
+            return;
+        }
+
+        for (uint32_t t = done; t < frames; ++t)
+        {
+            const float xL = (float)inL[t];
+            const float xR = (float)inR[t];
+
+            const float v3L = xL - ic2L;
+            const float v1L = a1 * ic1L + a2 * v3L;
+            const float v2L = ic2L + a2 * ic1L + a3 * v3L;
+            ic1L = 2.0f * v1L - ic1L;
+            ic2L = 2.0f * v2L - ic2L;
+
+            const float v3R = xR - ic2R;
+            const float v1R = a1 * ic1R + a2 * v3R;
+            const float v2R = ic2R + a2 * ic1R + a3 * v3R;
+            ic1R = 2.0f * v1R - ic1R;
+            ic2R = 2.0f * v2R - ic2R;
+
+            highL[t] = xL - k * v1L - v2L;
+            highR[t] = xR - k * v1R - v2R;
+            midL[t] = k * v1L;
+            midR[t] = k * v1R;
+            lowL[t] = v2L;
+            lowR[t] = v2R;
+        }
+
+        fState[0] = ic1L; fState[1] = ic2L; fState[2] = ic1R; fState[3] = ic2R;
+    }
+
+    /**
+       Stereo split of split() with the left and right channel in the lanes of one vector, four frames
+       at a time, returns the frames done. The state vector is { s1L, s1R, s2L, s2R } (first order) or
+       { ic1L, ic1R, ic2L, ic2R }, each lane does the arithmetic of the scalar loop in the same order,
+       so the result is the same to the bit. Double input is left to the scalar loop.
+     */
+    template <bool kFirstOrder>
+    uint32_t splitStereoSse(const double* const, const double* const, const uint32_t) noexcept
+    {
+        return 0;
+    }
+
+    template <bool kFirstOrder>
+    uint32_t splitStereoSse(const float* const inL, const float* const inR, const uint32_t frames) noexcept
+    {
+#if DL3Y_SSE_SPLIT
+        float* const highL = fSplit[2 * kDL3YBandHigh];
+        float* const highR = fSplit[2 * kDL3YBandHigh + 1];
+        float* const midL = fSplit[2 * kDL3YBandMid];
+        float* const midR = fSplit[2 * kDL3YBandMid + 1];
+        float* const lowL = fSplit[2 * kDL3YBandLow];
+        float* const lowR = fSplit[2 * kDL3YBandLow + 1];
+
+        __m128 state = _mm_setr_ps(fState[0], fState[2], fState[1], fState[3]);
+        const __m128 g = _mm_setr_ps(fCoeffs.g1, fCoeffs.g1, fCoeffs.g2, fCoeffs.g2);
+        const __m128 a = _mm_setr_ps(fCoeffs.a1, fCoeffs.a1, fCoeffs.a2, fCoeffs.a2);
+        const __m128 b = _mm_setr_ps(fCoeffs.a2, fCoeffs.a2, fCoeffs.a3, fCoeffs.a3);
+        const __m128 m = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+        const __m128 k = _mm_setr_ps(fCoeffs.k, fCoeffs.k, 1.0f, 1.0f);
+        const uint32_t end = frames & ~3u;
+
+        for (uint32_t t = 0; t < end; t += 4)
+        {
+            const __m128 l = _mm_loadu_ps(inL + t);
+            const __m128 r = _mm_loadu_ps(inR + t);
+            const __m128 lr01 = _mm_unpacklo_ps(l, r);
+            const __m128 lr23 = _mm_unpackhi_ps(l, r);
+            const __m128 x[4] = { _mm_movelh_ps(lr01, lr01), _mm_movehl_ps(lr01, lr01),
+                                  _mm_movelh_ps(lr23, lr23), _mm_movehl_ps(lr23, lr23) };
+
+            // per frame { lowL, lowR, midL, midR } (first order) or { midL, midR, lowL, lowR }, and high
+            __m128 bands[4], high[4];
+
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                if (kFirstOrder)
+                {
+                    // { v1, v2 } and { lp1, lp2 } of both channels
+                    const __m128 v = _mm_mul_ps(_mm_sub_ps(x[i], state), g);
+                    const __m128 lp = _mm_add_ps(v, state);
+                    const __m128 lp2 = _mm_movehl_ps(lp, lp);
+                    state = _mm_add_ps(lp, v);
+
+                    bands[i] = _mm_movelh_ps(lp, _mm_sub_ps(lp2, lp));
+                    high[i] = _mm_sub_ps(x[i], lp2);
+                }
+                else
+                {
+                    // { v1, v2 } of both channels, v1 = 0 + a1 * ic1 + a2 * v3 and v2 = ic2 + a2 * ic1 + a3 * v3
+                    const __m128 ic1 = _mm_movelh_ps(state, state);
+                    const __m128 ic2 = _mm_movehl_ps(state, state);
+                    const __m128 v3 = _mm_sub_ps(x[i], ic2);
+                    const __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m, ic2), _mm_mul_ps(a, ic1)), _mm_mul_ps(b, v3));
+                    state = _mm_sub_ps(_mm_add_ps(v, v), state);
+
+                    bands[i] = _mm_mul_ps(v, k);
+                    high[i] = _mm_sub_ps(_mm_sub_ps(x[i], bands[i]), _mm_movehl_ps(bands[i], bands[i]));
+                }
+            }
+
+            _MM_TRANSPOSE4_PS(bands[0], bands[1], bands[2], bands[3]);
+            _mm_storeu_ps((kFirstOrder ? lowL : midL) + t, bands[0]);
+            _mm_storeu_ps((kFirstOrder ? lowR : midR) + t, bands[1]);
+            _mm_storeu_ps((kFirstOrder ? midL : lowL) + t, bands[2]);
+            _mm_storeu_ps((kFirstOrder ? midR : lowR) + t, bands[3]);
+
+            const __m128 high01 = _mm_movelh_ps(high[0], high[1]);
+            const __m128 high23 = _mm_movelh_ps(high[2], high[3]);
+            _mm_storeu_ps(highL + t, _mm_shuffle_ps(high01, high23, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(highR + t, _mm_shuffle_ps(high01, high23, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, state);
+        fState[0] = lanes[0]; fState[1] = lanes[2]; fState[2] = lanes[1]; fState[3] = lanes[3];
+
+        return end;
+#else
+        (void)inL;
+        (void)inR;
+        (void)frames;
+        return 0;
+#endif
+    }
+
+    template <typename T>
+    static void clearOutputs(T* const* const outputs, const uint32_t offset, const uint32_t frames, const bool mono) noexcept
+    {
+        std::fill(outputs[0] + offset, outputs[0] + offset + frames, (T)0);
+        if (! mono)
+            std::fill(outputs[1] + offset, outputs[1] + offset + frames, (T)0);
+    }
+
+    template <typename T>
+    void splitChunk(const bool firstOrder, const bool mono, const T* const inL, const T* const inR, const uint32_t frames) noexcept
+    {
+        if (firstOrder)
+            mono ? split<true, true>(inL, inR, frames) : split<true, false>(inL, inR, frames);
+        else
+            mono ? split<false, true>(inL, inR, frames) : split<false, false>(inL, inR, frames);
+    }
+
+    /**
+       Split of the first chunk after switching between the first order and the state variable split:
+       both run on the chunk, the new one from the old one's state mapped onto it, and the band
+       buffers crossfade from the old split to the new one.
+     */
+    template <typename T>
+    void crossfadeSplits(const bool firstOrder, const bool mono, const T* const inL, const T* const inR, const uint32_t frames) noexcept
+    {
+        const float start[4] = { fState[0], fState[1], fState[2], fState[3] };
+
+        splitChunk(! firstOrder, mono, inL, inR, frames);
+        for (uint32_t i = 0; i < kDL3YLineCount; ++i)
+            std::memcpy(fSplitFrom[i], fSplit[i], frames * sizeof(float));
+
+        mapSplitState(firstOrder, start);
+        splitChunk(firstOrder, mono, inL, inR, frames);
+
+        const float step = 1.0f / (float)frames;
+
+        for (uint32_t i = 0; i < kDL3YLineCount; ++i)
+        {
+            float* const __restrict to = fSplit[i];
+            const float* const __restrict from = fSplitFrom[i];
+
+            for (uint32_t t = 0; t < frames; ++t)
+                to[t] = dl3yLinear(from[t], to[t], step * (float)(t + 1));
+        }
+    }
+
+    /**
+       Set the crossover state of one split from the other's: the state variable filter's integrators
+       hold its band and low outputs, the one-poles the lowpasses at the band edges, so
+       lp1 = low and lp2 = low + band.
+     */
+    void mapSplitState(const bool toFirstOrder, const float* const from) noexcept
+    {
+        const float k = fCoeffs.k;
+
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            const float a = from[2 * c], b = from[2 * c + 1];
+
+            if (toFirstOrder)
+            {
+                fState[2 * c] = b;
+                fState[2 * c + 1] = b + k * a;
+            }
+            else
+            {
+                fState[2 * c] = (b - a) / k;
+                fState[2 * c + 1] = a;
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Bands
+
+    float targetDelay(const uint32_t band) const noexcept
+    {
+        return std::max(fShortestDelay[band], std::min(fControls.delayFrames(band), (float)(fLineLength - kDL3YLineGuard)));
+    }
+
+    /**
+       Returns true when the band's delay time is still ramping or gliding towards its target,
+       snaps it to the target once it is close enough to read with a fixed fraction.
+     */
+    bool updateGlide(const uint32_t band) noexcept
+    {
+        if (fDelayStep[band] != 0.0f)
+            return true;
+
+        const float target = targetDelay(band);
+
+        if (std::fabs(fDelay[band] - target) < 1e-3f)
+        {
+            fDelay[band] = target;
+            return false;
+        }
+        return true;
+    }
+
+    float* line(const uint32_t band, const uint32_t channel) noexcept
+    {
+        return fLines->lines[2 * band + channel];
+    }
+
+    template <uint32_t kQuality, bool kMono, bool kEnabled, bool kGliding, bool kAccumulate, typename T>
+    void processBand(const uint32_t band, const uint32_t offset, const uint32_t frames, T* const outL, T* const outR) noexcept
+    {
+        float* const lineL = line(band, 0);
+        float* const lineR = line(band, 1);
+        const int32_t length = (int32_t)fLineLength;
+        const int32_t write = (int32_t)fWriteIndex;
+
+        // delayed reads of the whole chunk
+        if (kGliding)
+        {
+            // either the glide or the tempo ramp, the other term is zero
+            float d = fDelay[band];
+            const float target = targetDelay(band);
+            const float step = fDelayStep[band];
+            const float coeff = step != 0.0f ? 0.0f : fTimeCoeff;
+
+            for (uint32_t t = 0; t < frames; ++t)
+            {
+                d += (target - d) * coeff + step;
+
+                const int32_t whole = (int32_t)d;
+                int32_t r0 = write + (int32_t)t - whole;
+                r0 += r0 < 0 ? length : 0;
+                r0 -= r0 >= length ? length : 0;
+
+                fReadL[t] = readWrapped<kQuality>(lineL, r0, length, d - (float)whole);
+                if (!kMono)
+                    fReadR[t] = readWrapped<kQuality>(lineR, r0, length, d - (float)whole);
+            }
+
+            fDelay[band] = d;
+        }
+        else
+        {
+            const int32_t whole = (int32_t)fDelay[band];
+            const float frac = fDelay[band] - (float)whole;
+
+            readStatic<kQuality>(lineL, write - whole, length, frac, fReadL, frames);
+            if (!kMono)
+                readStatic<kQuality>(lineR, write - whole, length, frac, fReadR, frames);
+
+            if (fTapFade[band] < 1.0f)
+                crossfadeTaps<kQuality, kMono>(band, lineL, lineR, frames);
+        }
+
+        if (fLinesStale)
+            fadeReads(frames, kMono);
+
+        // mix, sum into the output and compute the feedback writes
+        if (kMono)
+            mixBandMono<kEnabled, kAccumulate>(fSplit[2 * band], fReadL, fWriteL, outL, offset, frames,
+                                               fControls.gain(band), fControls.feedback(band), fControls.cross(band), fControls.mix(band));
+        else
+            mixBand<kEnabled, kAccumulate>(fSplit[2 * band], fSplit[2 * band + 1], fReadL, fReadR, fWriteL, fWriteR,
+                                           outL, outR, offset, frames,
+                                           fControls.gain(band), fControls.feedback(band), fControls.cross(band), fControls.mix(band));
+
+        if (fRise < 1.0f)
+            riseWrites(frames, kMono);
+
+#if DL3Y_FLUSH_DENORMALS
+        dl3yFlushDenormals(fWriteL, frames);
+        if (! kMono)
+            dl3yFlushDenormals(fWriteR, frames);
+#endif
+
+        // write back, at most one wrap; in mono the right line gets the left writes, ready for stereo
+        const float* const writeR = kMono ? fWriteL : fWriteR;
+        const uint32_t first = std::min(frames, fLineLength - fWriteIndex);
+        std::memcpy(lineL + fWriteIndex, fWriteL, first * sizeof(float));
+        std::memcpy(lineR + fWriteIndex, writeR, first * sizeof(float));
+        std::memcpy(lineL, fWriteL + first, (frames - first) * sizeof(float));
+        std::memcpy(lineR, writeR + first, (frames - first) * sizeof(float));
+        fWritten = frames;
+    }
+
+    /**
+       The low band at the decimated rate. Its input with the ramped gain is decimated, and the delay
+       time, tap crossfade, line fades and feedback of processBand() run per decimated sample on lines at
+       that rate. The feedback loop reads at the delay time; the output tap reads earlier by the
+       resampler latency, is interpolated back and mixed at full rate, so the echoes stay where they are.
+       It always accumulates into the output; when the high and mid bands were both skipped it is the
+       first band of the chunk, so process() clears the output before it.
+     */
+    template <uint32_t kQuality, bool kMono, bool kGliding, typename T>
+    void processDecimatedBand(const uint32_t band, const uint32_t offset, const uint32_t frames, T* const outL, T* const outR) noexcept
+    {
+        float* const lineL = line(band, 0);
+        float* const lineR = line(band, 1);
+        const uint32_t decimation = fResampler.getDecimation();
+        const int32_t length = (int32_t)fLines->bandLength[band];
+        const int32_t write = (int32_t)fLowWriteIndex;
+        const float scale = 1.0f / (float)decimation;
+        const float latency = (float)fResampler.getLatency() * scale;
+
+        // band input, decimated
+        const DL3YRamp& gain(fControls.gain(band));
+        const float g0 = gain.value + gain.step * (float)offset, gs = gain.step;
+
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float g = g0 + gs * (float)(t + 1);
+
+            fBandL[t] = fSplit[2 * band][t] * g;
+            if (!kMono)
+                fBandR[t] = fSplit[2 * band + 1][t] * g;
+        }
+
+        // frame of the chunk each decimated sample belongs to is first + k * decimation
+        const uint32_t first = fResampler.firstFrame();
+        const uint32_t count = fResampler.down<kMono>(fBandL, fBandR, frames, fLowInL, fLowInR);
+
+        // delayed reads of the decimated chunk, the feedback tap and the output tap
+        if (kGliding)
+        {
+            float d = fDelay[band];
+            const float target = targetDelay(band);
+            const float step = fDelayStep[band] * (float)decimation;
+            const float coeff = step != 0.0f ? 0.0f : fLowTimeCoeff;
+
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                d += (target - d) * coeff + step;
+
+                const int32_t w = write + (int32_t)k;
+                fLowReadL[k] = readDecimated<kQuality>(lineL, w, length, d * scale);
+                fLowOutL[k] = readDecimated<kQuality>(lineL, w, length, d * scale - latency);
+                if (!kMono)
+                {
+                    fLowReadR[k] = readDecimated<kQuality>(lineR, w, length, d * scale);
+                    fLowOutR[k] = readDecimated<kQuality>(lineR, w, length, d * scale - latency);
+                }
+            }
+
+            fDelay[band] = d;
+        }
+        else
+        {
+            readDecimatedStatic<kQuality, kMono>(lineL, lineR, write, length, fDelay[band] * scale, fLowReadL, fLowReadR, count);
+            readDecimatedStatic<kQuality, kMono>(lineL, lineR, write, length, fDelay[band] * scale - latency, fLowOutL, fLowOutR, count);
+        }
+
+        if (fTapFade[band] < 1.0f)
+        {
+            const float from = fFadeFromDelay[band] * scale;
+
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const int32_t w = write + (int32_t)k;
+                const float g = std::min(1.0f, fTapFade[band] + fTapFadeStep * (float)(first + k * decimation + 1));
+
+                const float readL = readDecimated<kQuality>(lineL, w, length, from);
+                const float outFromL = readDecimated<kQuality>(lineL, w, length, from - latency);
+                fLowReadL[k] = readL + (fLowReadL[k] - readL) * g;
+                fLowOutL[k] = outFromL + (fLowOutL[k] - outFromL) * g;
+                if (!kMono)
+                {
+                    const float readR = readDecimated<kQuality>(lineR, w, length, from);
+                    const float outFromR = readDecimated<kQuality>(lineR, w, length, from - latency);
+                    fLowReadR[k] = readR + (fLowReadR[k] - readR) * g;
+                    fLowOutR[k] = outFromR + (fLowOutR[k] - outFromR) * g;
+                }
+            }
+
+            fTapFade[band] = std::min(1.0f, fTapFade[band] + fTapFadeStep * (float)frames);
+        }
+
+        if (fLinesStale)
+        {
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const float g = std::max(0.0f, fFade - fFadeStep * (float)(first + k * decimation + 1));
+
+                fLowReadL[k] *= g;
+                fLowOutL[k] *= g;
+                if (!kMono)
+                {
+                    fLowReadR[k] *= g;
+                    fLowOutR[k] *= g;
+                }
+            }
+        }
+
+        // feedback writes, with the feedback and cross ramps at the frame of each decimated sample
+        const DL3YRamp& feedback(fControls.feedback(band));
+        const DL3YRamp& cross(fControls.cross(band));
+        const float fb0 = feedback.value + feedback.step * (float)offset, fbs = feedback.step;
+        const float cr0 = cross.value + cross.step * (float)offset, crs = cross.step;
+
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const float ramp = (float)(first + k * decimation + 1);
+            const float fb = fb0 + fbs * ramp;
+            const float cr = cr0 + crs * ramp;
+
+            if (kMono)
+            {
+                fWriteL[k] = fLowInL[k] + fb * ((1.0f - cr) * fLowReadL[k] + cr * fLowReadL[k]);
+            }
+            else
+            {
+                fWriteL[k] = fLowInL[k] + fb * ((1.0f - cr) * fLowReadL[k] + cr * fLowReadR[k]);
+                fWriteR[k] = fLowInR[k] + fb * ((1.0f - cr) * fLowReadR[k] + cr * fLowReadL[k]);
+            }
+        }
+
+        if (fRise < 1.0f)
+        {
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const float g = std::min(1.0f, fRise + fFadeStep * (float)(first + k * decimation + 1));
+
+                fWriteL[k] *= g;
+                if (!kMono)
+                    fWriteR[k] *= g;
+            }
+        }
+
+#if DL3Y_FLUSH_DENORMALS
+        dl3yFlushDenormals(fWriteL, count);
+        if (! kMono)
+            dl3yFlushDenormals(fWriteR, count);
+#endif
+
+        // write back, at most one wrap; in mono the right line gets the left writes, ready for stereo
+        const float* const writeR = kMono ? fWriteL : fWriteR;
+        const uint32_t firstRun = std::min(count, (uint32_t)length - fLowWriteIndex);
+        std::memcpy(lineL + fLowWriteIndex, fWriteL, firstRun * sizeof(float));
+        std::memcpy(lineR + fLowWriteIndex, writeR, firstRun * sizeof(float));
+        std::memcpy(lineL, fWriteL + firstRun, (count - firstRun) * sizeof(float));
+        std::memcpy(lineR, writeR + firstRun, (count - firstRun) * sizeof(float));
+        fWritten = count;
+
+        fLowWriteIndex += count;
+        if (fLowWriteIndex >= (uint32_t)length)
+            fLowWriteIndex -= (uint32_t)length;
+
+        // back to full rate, mixed with the band input
+        fResampler.up<kMono>(fLowOutL, fLowOutR, count, fReadL, fReadR, frames);
+
+        const DL3YRamp& mix(fControls.mix(band));
+        const float mx0 = mix.value + mix.step * (float)offset, mxs = mix.step;
+
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float mx = mx0 + mxs * (float)(t + 1);
+
+            outL[t] += (T)((1.0f - mx) * fBandL[t] + mx * fReadL[t]);
+            if (!kMono)
+                outR[t] += (T)((1.0f - mx) * fBandR[t] + mx * fReadR[t]);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Kernels
+
+    /**
+       One interpolated read around r0, taps wrapped around the line.
+     */
+    template <uint32_t kQuality>
+    static float readWrapped(const float* const line, const int32_t r0, const int32_t length, const float frac) noexcept
+    {
+        typedef DL3YInterpolator<kQuality> Interpolator;
+        float taps[Interpolator::kOlder + 1 + Interpolator::kNewer];
+
+        for (int32_t j = -Interpolator::kOlder; j <= Interpolator::kNewer; ++j)
+        {
+            int32_t i = r0 + j;
+            i += i < 0 ? length : 0;
+            i -= i >= length ? length : 0;
+            taps[Interpolator::kOlder + j] = line[i];
+        }
+
+        return Interpolator::read(taps + Interpolator::kOlder, frac);
+    }
+
+    /**
+       One interpolated read of a decimated line, delay samples before the write position w.
+     */
+    template <uint32_t kQuality>
+    static float readDecimated(const float* const line, const int32_t w, const int32_t length, const float delay) noexcept
+    {
+        typedef DL3YInterpolator<kQuality> Interpolator;
+
+        const int32_t whole = (int32_t)delay;
+        const float frac = delay - (float)whole;
+        int32_t r0 = w - whole;
+        r0 += r0 < 0 ? length : 0;
+        r0 -= r0 >= length ? length : 0;
+
+        if (r0 < Interpolator::kOlder || r0 + Interpolator::kNewer >= length)
+            return readWrapped<kQuality>(line, r0, length, frac);
+
+        return Interpolator::read(line + r0, frac);
+    }
+
+    /**
+       Reads of consecutive decimated samples at a fixed delay from both lines, see readStatic().
+     */
+    template <uint32_t kQuality, bool kMono>
+    static void readDecimatedStatic(const float* const lineL, const float* const lineR, const int32_t write,
+                                    const int32_t length, const float delay, float* const outL, float* const outR,
+                                    const uint32_t count) noexcept
+    {
+        const int32_t whole = (int32_t)delay;
+        const float frac = delay - (float)whole;
+
+        readStatic<kQuality>(lineL, write - whole, length, frac, outL, count);
+        if (!kMono)
+            readStatic<kQuality>(lineR, write - whole, length, frac, outR, count);
+    }
+
+    /**
+       Reads of consecutive frames at a fixed delay, start is the first frame's r0 (may be negative).
+       Split into runs that do not wrap, each one a vectorizable loop. A whole frame delay, what
+       most synced and millisecond times come to at common rates, is a plain copy of the line.
+     */
+    template <uint32_t kQuality>
+    static void readStatic(const float* __restrict line, int32_t start, const int32_t length, const float frac,
+                           float* __restrict out, const uint32_t frames) noexcept
+    {
+        typedef DL3YInterpolator<kQuality> Interpolator;
+
+        start += start < 0 ? length : 0;
+
+        if (frac == 0.0f)
+        {
+            for (uint32_t t = 0; t < frames;)
+            {
+                int32_t r0 = start + (int32_t)t;
+                r0 -= r0 >= length ? length : 0;
+
+                const uint32_t run = std::min(frames - t, (uint32_t)(length - r0));
+                std::memcpy(out + t, line + r0, run * sizeof(float));
+                t += run;
+            }
+            return;
+        }
+
+        for (uint32_t t = 0; t < frames;)
+        {
+            int32_t r0 = start + (int32_t)t;
+            r0 -= r0 >= length ? length : 0;
+
+            if (r0 < Interpolator::kOlder || r0 + Interpolator::kNewer >= length)
+            {
+                out[t++] = readWrapped<kQuality>(line, r0, length, frac);
+                continue;
+            }
+
+            const size_t run = std::min(frames - t, (uint32_t)(length - Interpolator::kNewer - r0));
+            const float* const __restrict p = line + r0;
+            float* const __restrict o = out + t;
+
+            for (size_t i = 0; i < run; ++i)
+                o[i] = Interpolator::read(p + i, frac);
+
+            t += run;
+        }
+    }
+
+    /**
+       The dlay mix for one chunk: ramped gain, feedback, cross and mix, output summed into the host
+       buffer (or written, for the first band) and feedback values for the write back.
+     */
+    template <bool kEnabled, bool kAccumulate, typename T>
+    static void mixBand(const float* __restrict splitL, const float* __restrict splitR,
+                        const float* __restrict yL, const float* __restrict yR,
+                        float* __restrict writeL, float* __restrict writeR,
+                        T* __restrict outL, T* __restrict outR, const uint32_t offset, const uint32_t frames,
+                        const DL3YRamp& gain, const DL3YRamp& feedback, const DL3YRamp& cross, const DL3YRamp& mix) noexcept
+    {
+        const float g0 = gain.value + gain.step * (float)offset, gs = gain.step;
+        const float fb0 = feedback.value + feedback.step * (float)offset, fbs = feedback.step;
+        const float cr0 = cross.value + cross.step * (float)offset, crs = cross.step;
+        const float mx0 = mix.value + mix.step * (float)offset, mxs = mix.step;
+
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float ramp = (float)(t + 1);
+            const float fb = fb0 + fbs * ramp;
+            const float cr = cr0 + crs * ramp;
+            const float mx = mx0 + mxs * ramp;
+
+            float xL = 0.0f, xR = 0.0f;
+            if (kEnabled)
+            {
+                const float g = g0 + gs * ramp;
+                xL = splitL[t] * g;
+                xR = splitR[t] * g;
+            }
+
+            writeL[t] = xL + fb * ((1.0f - cr) * yL[t] + cr * yR[t]);
+            writeR[t] = xR + fb * ((1.0f - cr) * yR[t] + cr * yL[t]);
+
+            const float oL = (1.0f - mx) * xL + mx * yL[t];
+            const float oR = (1.0f - mx) * xR + mx * yR[t];
+
+            if (kAccumulate)
+            {
+                outL[t] += (T)oL;
+                outR[t] += (T)oR;
+            }
+            else
+            {
+                outL[t] = (T)oL;
+                outR[t] = (T)oR;
+            }
+        }
+    }
+
+    /**
+       mixBand for the left channel only, with the same arithmetic so mono and stereo chunks agree
+       to the bit on the same input. The output is written to the left host buffer.
+     */
+    template <bool kEnabled, bool kAccumulate, typename T>
+    static void mixBandMono(const float* __restrict split, const float* __restrict y, float* __restrict write,
+                            T* __restrict out, const uint32_t offset, const uint32_t frames,
+                            const DL3YRamp& gain, const DL3YRamp& feedback, const DL3YRamp& cross, const DL3YRamp& mix) noexcept
+    {
+        const float g0 = gain.value + gain.step * (float)offset, gs = gain.step;
+        const float fb0 = feedback.value + feedback.step * (float)offset, fbs = feedback.step;
+        const float cr0 = cross.value + cross.step * (float)offset, crs = cross.step;
+        const float mx0 = mix.value + mix.step * (float)offset, mxs = mix.step;
+
+        for (uint32_t t = 0; t < frames; ++t)
+        {
+            const float ramp = (float)(t + 1);
+            const float fb = fb0 + fbs * ramp;
+            const float cr = cr0 + crs * ramp;
+            const float mx = mx0 + mxs * ramp;
+
+            float x = 0.0f;
+            if (kEnabled)
+                x = split[t] * (g0 + gs * ramp);
+
+            write[t] = x + fb * ((1.0f - cr) * y[t] + cr * y[t]);
+
+            const float o = (1.0f - mx) * x + mx * y[t];
+
+            if (kAccumulate)
+                out[t] += (T)o;
+            else
+                out[t] = (T)o;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Kernel table, indexed by [quality][mono][enabled][gliding][accumulate]
+
+    template <typename T>
+    struct BandKernels {
+        typedef void (DL3YEngine::*Kernel)(uint32_t, uint32_t, uint32_t, T*, T*);
+        static const Kernel table[kDL3YQualityCount][2][2][2][2];
+    };
+
+    // the decimated low band, indexed by [quality][mono][gliding]
+    template <typename T>
+    struct DecimatedKernels {
+        typedef void (DL3YEngine::*Kernel)(uint32_t, uint32_t, uint32_t, T*, T*);
+        static const Kernel table[kDL3YQualityCount][2][2];
+    };
+
+    // ----------------------------------------------------------------------------------------------------------------
+
+    DL3YControls fControls;
+    DL3YCrossoverCoeffs fCoeffs;
+    DL3YQuality fQuality;
+    float fState[4];
+
+    bool fMonoDetection;
+    uint32_t fMonoFrames[kDL3YBandCount];
+    uint32_t fQuietFrames[kDL3YBandCount];
+
+    DL3YLineBuffer* fLines;
+    DL3YLineBuffer* fIncomingLines;
+    DL3YLineBuffer* fRetiredLines;
+    uint32_t fLineLength;
+    uint32_t fWriteIndex;
+    bool fLinesStale;
+    float fFade;
+    float fFadeStep;
+    float fRise;
+    float fTimeCoeff;
+    float fDelay[kDL3YBandCount];
+    float fDelayStep[kDL3YBandCount];
+    float fShortestDelay[kDL3YBandCount];
+
+    // decimated low band, see processDecimatedBand()
+    DL3YBandResampler fResampler;
+    uint32_t fLowWriteIndex;
+    float fLowTimeCoeff;
+
+    // parameter snapshot waiting for the next block, and the tap crossfades it started
+    float fSnapshot[kDL3YParameterCount];
+    bool fSnapshotPending;
+    float fFadeFromDelay[kDL3YBandCount];
+    float fTapFade[kDL3YBandCount];
+    float fTapFadeStep;
+
+    // chunk buffers
+    float fSplit[2 * kDL3YBandCount][kMaxChunk];
+    // the old split while switching between the first order and state variable ones
+    float fSplitFrom[2 * kDL3YBandCount][kMaxChunk];
+    float fReadL[kMaxChunk];
+    float fReadR[kMaxChunk];
+    float fOldReadL[kMaxChunk];
+    float fOldReadR[kMaxChunk];
+    float fWriteL[kMaxChunk];
+    float fWriteR[kMaxChunk];
+    uint32_t fWritten;
+    float fBandL[kMaxChunk];
+    float fBandR[kMaxChunk];
+    float fLowInL[kMaxChunk];
+    float fLowInR[kMaxChunk];
+    float fLowReadL[kMaxChunk];
+    float fLowReadR[kMaxChunk];
+    float fLowOutL[kMaxChunk];
+    float fLowOutR[kMaxChunk];
+
+#if DL3Y_LOAD_METER
+    DL3YLoadMeter* fLoadMeter;
+#endif
+};
+
+template <typename T>
+const typename DL3YEngine::BandKernels<T>::Kernel DL3YEngine::BandKernels<T>::table[kDL3YQualityCount][2][2][2][2] = {
+    {
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityEco, false, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, false, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityEco, false, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, false, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityEco, false, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, false, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityEco, false, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, false, true, true, true, T> },
+            },
+        },
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityEco, true, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, true, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityEco, true, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, true, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityEco, true, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, true, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityEco, true, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityEco, true, true, true, true, T> },
+            },
+        },
+    },
+    {
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityNormal, false, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, false, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityNormal, false, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, false, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityNormal, false, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, false, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityNormal, false, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, false, true, true, true, T> },
+            },
+        },
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityNormal, true, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, true, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityNormal, true, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, true, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityNormal, true, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, true, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityNormal, true, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityNormal, true, true, true, true, T> },
+            },
+        },
+    },
+    {
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityHigh, false, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, false, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityHigh, false, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, false, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityHigh, false, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, false, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityHigh, false, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, false, true, true, true, T> },
+            },
+        },
+        {
+            {
+                { &DL3YEngine::processBand<kDL3YQualityHigh, true, false, false, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, true, false, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityHigh, true, false, true, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, true, false, true, true, T> },
+            },
+            {
+                { &DL3YEngine::processBand<kDL3YQualityHigh, true, true, false, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, true, true, false, true, T> },
+                { &DL3YEngine::processBand<kDL3YQualityHigh, true, true, true, false, T>, &DL3YEngine::processBand<kDL3YQualityHigh, true, true, true, true, T> },
+            },
+        },
+    },
+};
+
+template <typename T>
+const typename DL3YEngine::DecimatedKernels<T>::Kernel DL3YEngine::DecimatedKernels<T>::table[kDL3YQualityCount][2][2] = {
+    {
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityEco, false, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityEco, false, true, T> },
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityEco, true, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityEco, true, true, T> },
+    },
+    {
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityNormal, false, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityNormal, false, true, T> },
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityNormal, true, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityNormal, true, true, T> },
+    },
+    {
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityHigh, false, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityHigh, false, true, T> },
+        { &DL3YEngine::processDecimatedBand<kDL3YQualityHigh, true, false, T>, &DL3YEngine::processDecimatedBand<kDL3YQualityHigh, true, true, T> },
+    },
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_ENGINE_HPP_INCLUDED
@@ -0,0 +1,425 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_LINES_HPP_INCLUDED
+#define DL3Y_LINES_HPP_INCLUDED
+
+#include "DL3YCrossoverTable.hpp"
+#include "DL3YParameters.hpp"
+#include "DL3YPrimitives.hpp"
+#include "DL3YResampler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+// stereo delay line of every band
+static const uint32_t kDL3YLineCount = 2 * kDL3YBandCount;
+
+// fade of the delayed signal when the sample rate changes under the lines, see DL3YEngine::changeSampleRate()
+static const double kDL3YLineFadeSeconds = 0.01;
+
+/**
+   Frames of one delay line at sampleRate: the longest delay plus the interpolation guard.
+ */
+static inline uint32_t dl3yLineLength(const double sampleRate) noexcept
+{
+    return (uint32_t)std::ceil(kDL3YMaxTimeMs * 0.001 * sampleRate) + kDL3YLineGuard;
+}
+
+/**
+   Frames of one delay line of a band, shorter by the decimation for the low band, see dl3yLowBandDecimation().
+ */
+static inline uint32_t dl3yBandLineLength(const uint32_t band, const double sampleRate) noexcept
+{
+    if (band != kDL3YBandLow)
+        return dl3yLineLength(sampleRate);
+
+    return (uint32_t)std::ceil(kDL3YMaxTimeMs * 0.001 * sampleRate / dl3yLowBandDecimation(sampleRate)) + kDL3YLineGuard;
+}
+
+/**
+   Storage of the delay lines at one sample rate, the stereo lines of every band, zeroed, along with
+   the shared crossover table of that rate.
+   Allocating one at 192 kHz means tens of MB to allocate and page in, so it should never happen
+   on the audio thread, see DL3YLineWorker.
+ */
+struct DL3YLineBuffer {
+    explicit DL3YLineBuffer(const double sampleRate)
+        : length(dl3yLineLength(sampleRate)),
+          decimation(dl3yLowBandDecimation(sampleRate)),
+          size(bandOffset(kDL3YBandCount, sampleRate)),
+          data(new float[size]),
+          crossover(dl3yCrossoverTable(sampleRate)),
+          next(nullptr)
+    {
+        // also touches every page, so the audio thread does not fault them in later
+        std::memset(data, 0, size * sizeof(float));
+
+        for (uint32_t b = 0; b < kDL3YBandCount; ++b)
+        {
+            bandLength[b] = dl3yBandLineLength(b, sampleRate);
+            lines[2 * b] = data + bandOffset(b, sampleRate);
+            lines[2 * b + 1] = lines[2 * b] + bandLength[b];
+        }
+    }
+
+    ~DL3YLineBuffer()
+    {
+        delete[] data;
+    }
+
+    // full rate line length, which identifies the sample rate the lines are for
+    const uint32_t length;
+    const uint32_t decimation;
+    const size_t size;
+    float* const data;
+    const DL3YCrossoverTable* const crossover;
+
+    uint32_t bandLength[kDL3YBandCount];
+    float* lines[kDL3YLineCount];
+
+    // link in the list of retired lines, see DL3YLineThread
+    DL3YLineBuffer* next;
+
+private:
+    static size_t bandOffset(const uint32_t band, const double sampleRate) noexcept
+    {
+        size_t offset = 0;
+
+        for (uint32_t b = 0; b < band; ++b)
+            offset += 2 * (size_t)dl3yBandLineLength(b, sampleRate);
+
+        return offset;
+    }
+
+    DL3YLineBuffer(const DL3YLineBuffer&);
+    DL3YLineBuffer& operator=(const DL3YLineBuffer&);
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   What a DL3YLineWorker shares with the line thread: the sample rate it asked for and the lines
+   prepared for it.
+ */
+struct DL3YLineSlot {
+    DL3YLineSlot() noexcept
+        : requestedRate(0.0),
+          ready(nullptr) {}
+
+    // guarded by the thread's mutex, 0 when nothing is requested
+    double requestedRate;
+    std::atomic<DL3YLineBuffer*> ready;
+};
+
+/**
+   The one background thread of the process allocating and freeing DL3YLineBuffers, for every
+   DL3YLineWorker. Started with the first worker and joined with the last one.
+
+   It sleeps on its condition variable until a worker requests lines or lines are retired. Retired
+   lines of all workers go onto one lock-free list linked through DL3YLineBuffer::next, which never
+   fills up; the audio threads wake the thread with try_lock() only, see wake().
+ */
+class DL3YLineThread
+{
+public:
+    static DL3YLineThread* acquire()
+    {
+        const std::lock_guard<std::mutex> lock(instanceMutex());
+        DL3YLineThread*& thread(instance());
+
+        if (thread == nullptr)
+            thread = new DL3YLineThread;
+
+        ++thread->fUsers;
+        return thread;
+    }
+
+    static void release()
+    {
+        const std::lock_guard<std::mutex> lock(instanceMutex());
+        DL3YLineThread*& thread(instance());
+
+        if (--thread->fUsers == 0)
+        {
+            delete thread;
+            thread = nullptr;
+        }
+    }
+
+    void add(DL3YLineSlot* const slot)
+    {
+        const std::lock_guard<std::mutex> lock(fMutex);
+        fSlots.push_back(slot);
+    }
+
+    /**
+       Forget slot, waiting for lines the thread is preparing for it.
+     */
+    void remove(DL3YLineSlot* const slot)
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+
+        while (fCurrent == slot)
+            fIdle.wait(lock);
+
+        for (size_t i = 0; i < fSlots.size(); ++i)
+        {
+            if (fSlots[i] == slot)
+            {
+                fSlots.erase(fSlots.begin() + i);
+                break;
+            }
+        }
+    }
+
+    void request(DL3YLineSlot* const slot, const double sampleRate)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(fMutex);
+            slot->requestedRate = sampleRate;
+        }
+        fCondition.notify_one();
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Audio threads
+
+    /**
+       Queue lines to be freed, wait-free apart from retrying on contention with other retires.
+     */
+    void retire(DL3YLineBuffer* const lines) noexcept
+    {
+        DL3YLineBuffer* head = fRetired.load(std::memory_order_relaxed);
+
+        do {
+            lines->next = head;
+        } while (! fRetired.compare_exchange_weak(head, lines, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+       Wake the thread for retired lines. Notifying under the mutex is what keeps the wake-up from
+       getting lost while the thread is about to sleep, so this only tries to take it: returns false
+       when it is held, the caller then tries again on its next block.
+     */
+    bool wake() noexcept
+    {
+        if (! fMutex.try_lock())
+            return false;
+
+        fCondition.notify_one();
+        fMutex.unlock();
+        return true;
+    }
+
+private:
+    DL3YLineThread()
+        : fUsers(0),
+          fNextSlot(0),
+          fCurrent(nullptr),
+          fStop(false),
+          fRetired(nullptr),
+          fThread(&DL3YLineThread::run, this) {}
+
+    ~DL3YLineThread()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fCondition.notify_one();
+        fThread.join();
+
+        freeRetired();
+    }
+
+    static std::mutex& instanceMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // not static functions, so every translation unit shares the same thread
+    static DL3YLineThread*& instance()
+    {
+        static DL3YLineThread* thread = nullptr;
+        return thread;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+
+        while (! fStop)
+        {
+            DL3YLineSlot* const slot = requestedSlot();
+            double sampleRate = 0.0;
+
+            if (slot != nullptr)
+            {
+                sampleRate = slot->requestedRate;
+                slot->requestedRate = 0.0;
+            }
+
+            // request() must not wait for allocating or freeing, remove() waits for this slot
+            fCurrent = slot;
+            lock.unlock();
+
+            DL3YLineBuffer* replaced = nullptr;
+
+            if (slot != nullptr)
+                replaced = slot->ready.exchange(new DL3YLineBuffer(sampleRate), std::memory_order_acq_rel);
+
+            lock.lock();
+            fCurrent = nullptr;
+            fIdle.notify_all();
+            lock.unlock();
+
+            // prepared for a rate that was requested again before the audio thread took them
+            delete replaced;
+            freeRetired();
+
+            lock.lock();
+
+            while (! fStop && ! hasRequest() && fRetired.load(std::memory_order_acquire) == nullptr)
+                fCondition.wait(lock);
+        }
+    }
+
+    // with the mutex held; slots take turns, starting after the one served last
+    DL3YLineSlot* requestedSlot() noexcept
+    {
+        for (size_t i = 0; i < fSlots.size(); ++i)
+        {
+            DL3YLineSlot* const slot = fSlots[(fNextSlot + i) % fSlots.size()];
+
+            if (slot->requestedRate > 0.0)
+            {
+                fNextSlot = (fNextSlot + i + 1) % fSlots.size();
+                return slot;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // with the mutex held
+    bool hasRequest() const noexcept
+    {
+        for (size_t i = 0; i < fSlots.size(); ++i)
+        {
+            if (fSlots[i]->requestedRate > 0.0)
+                return true;
+        }
+
+        return false;
+    }
+
+    void freeRetired()
+    {
+        DL3YLineBuffer* lines = fRetired.exchange(nullptr, std::memory_order_acquire);
+
+        while (lines != nullptr)
+        {
+            DL3YLineBuffer* const next = lines->next;
+            delete lines;
+            lines = next;
+        }
+    }
+
+    uint32_t fUsers;
+
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    std::condition_variable fIdle;
+    std::vector<DL3YLineSlot*> fSlots;
+    size_t fNextSlot;
+    DL3YLineSlot* fCurrent;
+    bool fStop;
+
+    std::atomic<DL3YLineBuffer*> fRetired;
+
+    // started last, once everything it uses is constructed
+    std::thread fThread;
+};
+
+/**
+   Allocates and frees DL3YLineBuffers for an engine that runs on the audio thread, on the process
+   wide DL3YLineThread.
+
+   request() asks for lines for a new sample rate from any thread but the audio one. The audio thread picks
+   them up with take() between blocks and hands the ones it no longer uses back with retire(), both
+   wait-free, so neither allocation nor freeing ever happens there. Lines prepared for a rate the engine
+   has left again before taking them should be taken and retired as well.
+ */
+class DL3YLineWorker
+{
+public:
+    DL3YLineWorker()
+        : fThread(DL3YLineThread::acquire()),
+          fWakePending(false)
+    {
+        fThread->add(&fSlot);
+    }
+
+    ~DL3YLineWorker()
+    {
+        fThread->remove(&fSlot);
+        delete fSlot.ready.exchange(nullptr);
+        DL3YLineThread::release();
+    }
+
+    /**
+       Prepare lines for sampleRate, replacing any earlier ones the audio thread did not take yet.
+     */
+    void request(const double sampleRate)
+    {
+        fThread->request(&fSlot, sampleRate);
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Audio thread, call take() once per block
+
+    /**
+       The prepared lines, or nullptr while there are none. The caller owns them until it retires them.
+       Also retries waking the thread when the last retire() could not.
+     */
+    DL3YLineBuffer* take() noexcept
+    {
+        if (fWakePending)
+            fWakePending = ! fThread->wake();
+
+        if (fSlot.ready.load(std::memory_order_relaxed) == nullptr)
+            return nullptr;
+
+        return fSlot.ready.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    /**
+       Hand lines back to be freed.
+     */
+    void retire(DL3YLineBuffer* const lines) noexcept
+    {
+        fThread->retire(lines);
+        fWakePending = ! fThread->wake();
+    }
+
+private:
+    DL3YLineThread* const fThread;
+    DL3YLineSlot fSlot;
+    bool fWakePending;
+
+    DL3YLineWorker(const DL3YLineWorker&);
+    DL3YLineWorker& operator=(const DL3YLineWorker&);
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_LINES_HPP_INCLUDED
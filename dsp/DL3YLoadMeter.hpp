@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_LOAD_METER_HPP_INCLUDED
+#define DL3Y_LOAD_METER_HPP_INCLUDED
+
+#include "DL3YSpscRing.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
+
+// instrumentation of the audio path, off unless built with DL3Y_LOAD_METER=1
+#ifndef DL3Y_LOAD_METER
+# define DL3Y_LOAD_METER 0
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Measured stages of one run(), in processing order.
+   Output is the sum into the host buffers together with everything run() does around the DSP
+   (parameter and tempo dispatch, silence detection).
+ */
+enum DL3YLoadStage {
+    kDL3YStageCrossover,
+    kDL3YStageHigh,
+    kDL3YStageMid,
+    kDL3YStageLow,
+    kDL3YStageOutput,
+    kDL3YStageCount
+};
+
+/**
+   Free running cycle counter: TSC on x86, the virtual counter on aarch64, nanoseconds elsewhere.
+   Only differences within one run() are used, they are scaled to time with the run's wall clock.
+ */
+static inline uint64_t dl3yCycles() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+   Load of each stage in percent of the realtime budget, over one publish period.
+ */
+struct DL3YLoadFrame {
+    float average[kDL3YStageCount];
+    float peak[kDL3YStageCount];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Per stage CPU load of the audio path.
+
+   The audio thread calls begin() at the start of run(), mark() at the end of each stage and end()
+   last. Average and peak block load are collected for kPublishSeconds and then pushed as one frame,
+   so the ring only sees a few dozen frames per second whatever the block size.
+   The editor drains them with read().
+ */
+class DL3YLoadMeter
+{
+public:
+    static constexpr double kPublishSeconds = 0.02;
+
+    DL3YLoadMeter() noexcept
+    {
+        clear();
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Audio thread
+
+    void begin() noexcept
+    {
+        fStartTime = std::chrono::steady_clock::now();
+        fStart = fLast = dl3yCycles();
+    }
+
+    void mark(const DL3YLoadStage stage) noexcept
+    {
+        const uint64_t now = dl3yCycles();
+        fCycles[stage] += now - fLast;
+        fLast = now;
+    }
+
+    void end(const uint32_t frames, const double sampleRate) noexcept
+    {
+        mark(kDL3YStageOutput);
+
+        const uint64_t total = fLast - fStart;
+        const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - fStartTime).count();
+        const double budgetNs = 1e9 * frames / sampleRate;
+        const double scale = total != 0 && budgetNs > 0.0 ? 100.0 * ns / (budgetNs * (double)total) : 0.0;
+
+        for (uint32_t s = 0; s < kDL3YStageCount; ++s)
+        {
+            const float load = (float)(scale * (double)fCycles[s]);
+
+            fSum[s] += load * frames;
+            if (load > fFrame.peak[s])
+                fFrame.peak[s] = load;
+
+            fCycles[s] = 0;
+        }
+
+        fFrames += frames;
+        if (fFrames < kPublishSeconds * sampleRate)
+            return;
+
+        for (uint32_t s = 0; s < kDL3YStageCount; ++s)
+            fFrame.average[s] = fSum[s] / (float)fFrames;
+
+        // a full ring means the editor is closed or stalled, the frame is simply dropped
+        fRing.push(fFrame);
+        clear();
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Editor thread
+
+    bool read(DL3YLoadFrame& frame) noexcept
+    {
+        return fRing.pop(frame);
+    }
+
+private:
+    void clear() noexcept
+    {
+        for (uint32_t s = 0; s < kDL3YStageCount; ++s)
+        {
+            fCycles[s] = 0;
+            fSum[s] = 0.0f;
+            fFrame.average[s] = 0.0f;
+            fFrame.peak[s] = 0.0f;
+        }
+        fFrames = 0;
+    }
+
+    std::chrono::steady_clock::time_point fStartTime;
+    uint64_t fStart = 0;
+    uint64_t fLast = 0;
+    uint64_t fCycles[kDL3YStageCount];
+    float fSum[kDL3YStageCount];
+    uint32_t fFrames;
+    DL3YLoadFrame fFrame;
+
+    DL3YSpscRing<DL3YLoadFrame, 64> fRing;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_LOAD_METER_HPP_INCLUDED
@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_PARAMETERS_HPP_INCLUDED
+#define DL3Y_PARAMETERS_HPP_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------------------------------------------
+// Parameters of the WSTD_DL3Y graph, in the same order as the plugin and UI indices
+
+enum DL3YParameter {
+    kDL3YHigh,
+    kDL3YHigh_Cross,
+    kDL3YHigh_Feedback,
+    kDL3YHigh_Mix,
+    kDL3YHigh_Sync,
+    kDL3YHigh_Time,
+    kDL3YHigh_TimeSync,
+    kDL3YLow,
+    kDL3YLow_Cross,
+    kDL3YLow_Feedback,
+    kDL3YLow_Mix,
+    kDL3YLow_Sync,
+    kDL3YLow_Time,
+    kDL3YLow_TimeSync,
+    kDL3YMid,
+    kDL3YMid_Cross,
+    kDL3YMid_Feedback,
+    kDL3YMid_Freq,
+    kDL3YMid_Mix,
+    kDL3YMid_Sync,
+    kDL3YMid_Time,
+    kDL3YMid_TimeSync,
+    kDL3YQuality,
+    kDL3YParameterCount
+};
+
+enum DL3YBand {
+    kDL3YBandHigh,
+    kDL3YBandMid,
+    kDL3YBandLow,
+    kDL3YBandCount
+};
+
+struct DL3YParameterRange {
+    const char* receiver;
+    float min;
+    float max;
+    float def;
+};
+
+// receivers, ranges and defaults as declared with @hv_param in WSTD_DL3Y.pd
+static const DL3YParameterRange kDL3YParameterRanges[kDL3YParameterCount] = {
+    { "High",          -15.0f,   15.0f,    0.0f },
+    { "High_Cross",      0.0f,  100.0f,   20.0f },
+    { "High_Feedback",   0.0f,  100.0f,   25.0f },
+    { "High_Mix",        0.0f,  100.0f,   50.0f },
+    { "High_Sync",       0.0f,    1.0f,    0.0f },
+    { "High_Time",      50.0f, 5000.0f,  500.0f },
+    { "High_TimeSync",   0.0f,   12.0f,    6.0f },
+    { "Low",           -15.0f,   15.0f,    0.0f },
+    { "Low_Cross",       0.0f,  100.0f,   20.0f },
+    { "Low_Feedback",    0.0f,  100.0f,   25.0f },
+    { "Low_Mix",         0.0f,  100.0f,   50.0f },
+    { "Low_Sync",        0.0f,    1.0f,    0.0f },
+    { "Low_Time",       50.0f, 5000.0f,  500.0f },
+    { "Low_TimeSync",    0.0f,   12.0f,    6.0f },
+    { "Mid",           -15.0f,   15.0f,    0.0f },
+    { "Mid_Cross",       0.0f,  100.0f,   20.0f },
+    { "Mid_Feedback",    0.0f,  100.0f,   25.0f },
+    { "Mid_Freq",      313.3f, 5705.6f, 1337.0f },
+    { "Mid_Mix",         0.0f,  100.0f,   50.0f },
+    { "Mid_Sync",        0.0f,    1.0f,    0.0f },
+    { "Mid_Time",       50.0f, 5000.0f,  500.0f },
+    { "Mid_TimeSync",    0.0f,   12.0f,    6.0f },
+    { "Quality",         0.0f,    2.0f,    1.0f },
+};
+
+/**
+   Parameter indices of one band, so band processing can be written once.
+ */
+struct DL3YBandParameters {
+    uint32_t amount;
+    uint32_t cross;
+    uint32_t feedback;
+    uint32_t mix;
+    uint32_t sync;
+    uint32_t time;
+    uint32_t timeSync;
+};
+
+static const DL3YBandParameters kDL3YBandParameters[kDL3YBandCount] = {
+    { kDL3YHigh, kDL3YHigh_Cross, kDL3YHigh_Feedback, kDL3YHigh_Mix, kDL3YHigh_Sync, kDL3YHigh_Time, kDL3YHigh_TimeSync },
+    { kDL3YMid,  kDL3YMid_Cross,  kDL3YMid_Feedback,  kDL3YMid_Mix,  kDL3YMid_Sync,  kDL3YMid_Time,  kDL3YMid_TimeSync  },
+    { kDL3YLow,  kDL3YLow_Cross,  kDL3YLow_Feedback,  kDL3YLow_Mix,  kDL3YLow_Sync,  kDL3YLow_Time,  kDL3YLow_TimeSync  },
+};
+
+// delay time factors of the 13 TimeSync entries, the dl3y_timesync table the bpm_time_sync subpatches read
+static const uint32_t kDL3YTimeSyncCount = 13;
+static const float kDL3YTimeSyncFactors[kDL3YTimeSyncCount] = {
+    0.166667f, 0.2f, 0.25f, 0.333333f, 0.6f, 0.666667f, 1.0f, 1.5f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f
+};
+
+// the "min 5000" in front of each dlay, also the size of every delay line
+static const float kDL3YMaxTimeMs = 5000.0f;
+
+static const float kDL3YDefaultBpm = 120.0f;
+
+/**
+   Entries of the Quality parameter.
+   Eco reads the delays with linear interpolation and splits with one-pole filters, Normal is the
+   graph's Hermite read and state variable crossover, High reads with 6-point Lagrange interpolation.
+ */
+enum DL3YQuality {
+    kDL3YQualityEco,
+    kDL3YQualityNormal,
+    kDL3YQualityHigh,
+    kDL3YQualityCount
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// Mappings from parameter values to DSP values, the same scaling the patch applies before each object
+
+/**
+   Band amount in dB to linear gain, full left (-15 dB) switches the band off.
+ */
+static inline float dl3yBandGain(const float db) noexcept
+{
+    return db <= kDL3YParameterRanges[kDL3YHigh].min ? 0.0f : std::pow(10.0f, db * 0.05f);
+}
+
+/**
+   Percentage knobs (mix, feedback, cross) to 0..1, the "/ 100" in the patch.
+ */
+static inline float dl3yPercent(const float value) noexcept
+{
+    return value * 0.01f;
+}
+
+/**
+   Quality parameter value to its entry.
+ */
+static inline DL3YQuality dl3yQuality(const float value) noexcept
+{
+    const int item = (int)(value + 0.5f);
+    return item <= 0 ? kDL3YQualityEco : item >= (int)kDL3YQualityHigh ? kDL3YQualityHigh : kDL3YQualityNormal;
+}
+
+/**
+   One beat in ms at the host tempo, the shared dl3y_beat_ms of the graph. Computed once per tempo
+   change and used by every band.
+ */
+static inline float dl3yBeatMs(const float bpm) noexcept
+{
+    return 60000.0f / (bpm > 0.0f ? bpm : kDL3YDefaultBpm);
+}
+
+/**
+   Effective band delay time in ms, either the free time or the tempo synced one.
+ */
+static inline float dl3yBandTimeMs(const float timeMs, const bool sync, const float timeSync, const float beatMs) noexcept
+{
+    if (! sync)
+        return timeMs;
+
+    const int item = (int)(timeSync + 0.5f);
+    const uint32_t index = item < 0 ? 0 : item >= (int)kDL3YTimeSyncCount ? kDL3YTimeSyncCount - 1 : (uint32_t)item;
+
+    return std::fmin(beatMs * kDL3YTimeSyncFactors[index], kDL3YMaxTimeMs);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_PARAMETERS_HPP_INCLUDED
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_PRIMITIVES_HPP_INCLUDED
+#define DL3Y_PRIMITIVES_HPP_INCLUDED
+
+#include "DL3YParameters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// flush the engine's recursive state by hand, for targets without a flush to zero mode (WebAssembly)
+#ifndef DL3Y_FLUSH_DENORMALS
+# define DL3Y_FLUSH_DENORMALS 0
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Building blocks shared by the native DL3Y engines
+
+/**
+   Crossover coefficients for the mid frequency, with the mid Q the graph derives from it.
+   The split is a state variable filter whose low, band and high outputs sum back to the input,
+   so with all amounts at 0 dB the crossover is transparent.
+   g1 and g2 are one-pole lowpasses at the -3 dB edges of the band output, for the cheaper
+   first order split: low = lp1, mid = lp2 - lp1, high = input - lp2, which also sums back.
+ */
+struct DL3YCrossoverCoeffs {
+    float a1, a2, a3, k;
+    float g1, g2;
+};
+
+/**
+   Bandwidth of the mid band in octaves at freq, the eqmidq step of the graph's Mid_Freq chain
+   (Mid_Freq -> eqmidq -> qcalc -> midq of stereo_eq_pass): the band reaches from freq to the nearer
+   end of the Mid_Freq range on both sides, at least one octave wide.
+ */
+static inline double dl3yMidBandwidth(const double freq) noexcept
+{
+    const DL3YParameterRange& range(kDL3YParameterRanges[kDL3YMid_Freq]);
+    const double below = std::log2(freq / range.min);
+    const double above = std::log2(range.max / freq);
+
+    return std::max(1.0, 2.0 * std::min(below, above));
+}
+
+/**
+   Q of a band octaves wide, the qcalc step of the chain.
+ */
+static inline double dl3yBandwidthQ(const double octaves) noexcept
+{
+    const double ratio = std::exp2(octaves);
+    return std::sqrt(ratio) / (ratio - 1.0);
+}
+
+static inline float dl3yOnePoleCoeff(const double freq, const double sampleRate) noexcept
+{
+    const double g = std::tan(M_PI * std::fmin(freq, 0.49 * sampleRate) / sampleRate);
+    return (float)(g / (1.0 + g));
+}
+
+static inline DL3YCrossoverCoeffs dl3yCrossoverCoeffs(const float freq, const double sampleRate) noexcept
+{
+    const double g = std::tan(M_PI * std::fmin((double)freq, 0.49 * sampleRate) / sampleRate);
+    const double k = 1.0 / dl3yBandwidthQ(dl3yMidBandwidth(freq));
+    const double a1 = 1.0 / (1.0 + g * (g + k));
+
+    DL3YCrossoverCoeffs c;
+    c.a1 = (float)a1;
+    c.a2 = (float)(g * a1);
+    c.a3 = (float)(g * g * a1);
+    c.k = (float)k;
+
+    const double edge = std::sqrt(1.0 + 0.25 * k * k);
+    c.g1 = dl3yOnePoleCoeff(freq * (edge - 0.5 * k), sampleRate);
+    c.g2 = dl3yOnePoleCoeff(freq * (edge + 0.5 * k), sampleRate);
+    return c;
+}
+
+/**
+   4-point, 3rd-order Hermite interpolation between x0 and x1, t in [0, 1).
+ */
+static inline float dl3yHermite(const float xm1, const float x0, const float x1, const float x2, const float t) noexcept
+{
+    const float c = 0.5f * (x1 - xm1);
+    const float v = x0 - x1;
+    const float w = c + v;
+    const float a = w + v + 0.5f * (x2 - x0);
+    const float b = w + a;
+
+    return ((a * t - b) * t + c) * t + x0;
+}
+
+/**
+   Linear interpolation between x0 and x1, t in [0, 1).
+ */
+static inline float dl3yLinear(const float x0, const float x1, const float t) noexcept
+{
+    return x0 + t * (x1 - x0);
+}
+
+/**
+   6-point, 5th-order Lagrange interpolation between x0 and x1, t in [0, 1).
+   Flatter passband than the Hermite read, which matters most while delay times move.
+ */
+static inline float dl3yLagrange6(const float xm2, const float xm1, const float x0, const float x1, const float x2,
+                                  const float x3, const float t) noexcept
+{
+    const float a = t + 2.0f, b = t + 1.0f, d = t - 1.0f, e = t - 2.0f, f = t - 3.0f;
+    const float ab = a * b, de = d * e, ef = e * f;
+
+    return xm2 * (b * t * de * f * (-1.0f / 120.0f))
+         + xm1 * (a * t * de * f * (1.0f / 24.0f))
+         + x0  * (ab * de * f * (-1.0f / 12.0f))
+         + x1  * (ab * t * ef * (1.0f / 12.0f))
+         + x2  * (ab * t * d * f * (-1.0f / 24.0f))
+         + x3  * (ab * t * de * (1.0f / 120.0f));
+}
+
+// time constant of the delay time glide, so time and tempo changes sweep instead of click
+static const double kDL3YTimeSmoothingSeconds = 0.05;
+
+// steepest tempo change, in frames of delay per frame, followed with a linear ramp over the host block
+// instead of the glide; larger tempo jumps glide like any other time change
+static const float kDL3YTempoRampSlope = 0.05f;
+
+// crossfade from the old to the new tap when a parameter snapshot changes a delay time, see DL3YEngine
+static const double kDL3YTapFadeSeconds = 0.02;
+
+// extra samples around each delay line for the interpolation taps
+static const unsigned kDL3YLineGuard = 4;
+
+// largest left / right difference (-120 dBFS) still treated as the same signal by the mono detection
+static const float kDL3YMonoThreshold = 1e-6f;
+
+/**
+   True when a and b differ by at most kDL3YMonoThreshold in every frame.
+   Checked in blocks of 16 so the common stereo case leaves early without losing vectorization.
+ */
+template <typename T>
+static inline bool dl3ySameSignal(const T* const a, const T* const b, const uint32_t frames) noexcept
+{
+    for (uint32_t t = 0; t < frames; t += 16)
+    {
+        const uint32_t end = frames - t < 16 ? frames : t + 16;
+        bool same = true;
+
+        for (uint32_t i = t; i < end; ++i)
+            same &= std::fabs(a[i] - b[i]) <= (T)kDL3YMonoThreshold;
+
+        if (!same)
+            return false;
+    }
+
+    return true;
+}
+
+// largest delay line value (-120 dBFS) of a band tail treated as decayed, see DL3YEngine::process()
+static const float kDL3YQuietThreshold = 1e-6f;
+
+/**
+   True when every frame of x is within kDL3YQuietThreshold of zero.
+ */
+static inline bool dl3yQuiet(const float* const x, const uint32_t frames) noexcept
+{
+    bool quiet = true;
+
+    for (uint32_t t = 0; t < frames; ++t)
+        quiet &= std::fabs(x[t]) <= kDL3YQuietThreshold;
+
+    return quiet;
+}
+
+// smallest value (-300 dBFS) kept in recursive state by DL3Y_FLUSH_DENORMALS builds
+static const float kDL3YDenormalThreshold = 1e-15f;
+
+/**
+   Zero the values of x within kDL3YDenormalThreshold of zero, long before a decay reaches denormals.
+ */
+static inline void dl3yFlushDenormals(float* const x, const uint32_t count) noexcept
+{
+    for (uint32_t i = 0; i < count; ++i)
+        x[i] = std::fabs(x[i]) < kDL3YDenormalThreshold ? 0.0f : x[i];
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_PRIMITIVES_HPP_INCLUDED
@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_RESAMPLER_HPP_INCLUDED
+#define DL3Y_RESAMPLER_HPP_INCLUDED
+
+#include "DL3YParameters.hpp"
+
+#include <cmath>
+#include <cstring>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+// largest decimation of the low band delay
+static const uint32_t kDL3YMaxDecimation = 8;
+
+// taps of the resampling filters per decimated sample, the filters are kDL3YResamplerTaps * decimation long
+static const uint32_t kDL3YResamplerTaps = 12;
+
+// The low band delay runs at the host rate divided by the largest power of two that keeps it at or above
+// this rate. The band is a 12 dB/octave lowpass at Mid_Freq, at most 5705.6 Hz, so the decimated
+// Nyquist frequency stays two octaves above the highest split and nothing audible is lost. A fixed
+// rate per sample rate, rather than one that follows Mid_Freq, keeps the echoes in the line when the
+// split is automated.
+static const double kDL3YLowBandMinRate = 44100.0;
+
+/**
+   Decimation of the low band delay at sampleRate: 1 up to 48 kHz, 2 at 88.2 / 96 kHz, 4 at 176.4 / 192 kHz.
+ */
+static inline uint32_t dl3yLowBandDecimation(const double sampleRate) noexcept
+{
+    uint32_t decimation = 1;
+
+    while (decimation < kDL3YMaxDecimation && sampleRate / (2 * decimation) >= kDL3YLowBandMinRate)
+        decimation *= 2;
+
+    return decimation;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Polyphase decimator and interpolator of one stereo band, by the same factor, for a delay that runs at
+   the decimated rate in between.
+
+   Both use one Kaiser windowed sinc lowpass. A chunk is processed in three passes: down() computes the
+   decimated samples of the chunk, the caller runs its delay over them, and up() turns what it read back
+   into a full rate signal. A decimated sample is produced at every decimation-th frame and goes into the
+   interpolator at that same frame, so chunks can have any length and the two sides stay in step; the
+   round trip delays the signal by getLatency() frames.
+ */
+class DL3YBandResampler
+{
+public:
+    static const uint32_t kMaxFrames = 256;
+    static const uint32_t kMaxLength = kDL3YResamplerTaps * kDL3YMaxDecimation;
+
+    DL3YBandResampler() noexcept
+    {
+        setDecimation(1);
+    }
+
+    uint32_t getDecimation() const noexcept { return fDecimation; }
+
+    /**
+       Frames from the full rate input of down() to the output of up(), the filters' group delays.
+     */
+    uint32_t getLatency() const noexcept { return fLength - 1; }
+
+    /**
+       Design the filters for a new decimation, also clears the state.
+     */
+    void setDecimation(const uint32_t decimation) noexcept
+    {
+        fDecimation = decimation < 1 ? 1 : decimation > kDL3YMaxDecimation ? kDL3YMaxDecimation : decimation;
+        fLength = kDL3YResamplerTaps * fDecimation;
+
+        // cutoff at 42% of the decimated rate, Kaiser beta 7 for about 70 dB of stopband
+        const double cutoff = 0.42 / fDecimation;
+        const double beta = 7.0;
+        const double centre = 0.5 * (fLength - 1);
+        double h[kMaxLength];
+        double sum = 0.0;
+
+        for (uint32_t j = 0; j < fLength; ++j)
+        {
+            const double x = (double)j - centre;
+            const double r = x / centre;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * M_PI * cutoff * x) / (2.0 * M_PI * cutoff * x);
+
+            h[j] = sinc * besselI0(beta * std::sqrt(std::fmax(0.0, 1.0 - r * r)));
+            sum += h[j];
+        }
+
+        // unity gain down, and decimation times the taps up to make up for the skipped frames
+        for (uint32_t j = 0; j < fLength; ++j)
+            fDown[j] = (float)(h[j] / sum);
+
+        for (uint32_t p = 0; p < fDecimation; ++p)
+            for (uint32_t k = 0; k < kDL3YResamplerTaps; ++k)
+                fUp[p][kDL3YResamplerTaps - 1 - k] = (float)(fDecimation * h[p + k * fDecimation] / sum);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::memset(fDownHistory, 0, sizeof(fDownHistory));
+        std::memset(fUpHistory, 0, sizeof(fUpHistory));
+        fPhase = 0;
+    }
+
+    /**
+       Frame of the chunk at which down() produces its first decimated sample, the others follow every
+       decimation frames.
+     */
+    uint32_t firstFrame() const noexcept { return fDecimation - 1 - fPhase; }
+
+    /**
+       Decimate frames of input into out, returns the number of decimated samples.
+       kMono only runs the left channel and copies its state to the right one.
+     */
+    template <bool kMono>
+    uint32_t down(const float* const inL, const float* const inR, const uint32_t frames,
+                  float* const outL, float* const outR) noexcept
+    {
+        const uint32_t count = (fPhase + frames) / fDecimation;
+
+        downChannel(fDownHistory[0], inL, frames, outL, count);
+        if (kMono)
+            std::memcpy(fDownHistory[1], fDownHistory[0], (fLength - 1) * sizeof(float));
+        else
+            downChannel(fDownHistory[1], inR, frames, outR, count);
+
+        return count;
+    }
+
+    /**
+       Interpolate the count samples of the last down() back to frames of full rate output.
+     */
+    template <bool kMono>
+    void up(const float* const inL, const float* const inR, const uint32_t count,
+            float* const outL, float* const outR, const uint32_t frames) noexcept
+    {
+        upChannel(fUpHistory[0], inL, count, outL, frames);
+        if (kMono)
+            std::memcpy(fUpHistory[1], fUpHistory[0], kDL3YResamplerTaps * sizeof(float));
+        else
+            upChannel(fUpHistory[1], inR, count, outR, frames);
+
+        fPhase = (fPhase + frames) % fDecimation;
+    }
+
+private:
+    static double besselI0(const double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 32 && term > 1e-12 * sum; ++k)
+        {
+            term *= (0.5 * x / k) * (0.5 * x / k);
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // history holds the last fLength - 1 input frames, followed by the chunk
+    void downChannel(float* const history, const float* const in, const uint32_t frames, float* const out,
+                     const uint32_t count) noexcept
+    {
+        const uint32_t keep = fLength - 1;
+        std::memcpy(history + keep, in, frames * sizeof(float));
+
+        switch (fDecimation)
+        {
+        case 2: downTaps<2>(history + firstFrame(), out, count); break;
+        case 4: downTaps<4>(history + firstFrame(), out, count); break;
+        case 8: downTaps<8>(history + firstFrame(), out, count); break;
+        default: std::memcpy(out, history + keep, count * sizeof(float)); break;
+        }
+
+        std::memmove(history, history + frames, keep * sizeof(float));
+    }
+
+    // polyphase: every input phase is gathered once into consecutive samples and runs through its
+    // kDL3YResamplerTaps taps, one tap at a time over all outputs, so the inner loops vectorize
+    template <uint32_t kDecimation>
+    void downTaps(const float* const x, float* const __restrict out, const uint32_t count) noexcept
+    {
+        float* const __restrict phase = fScratch;
+
+        for (size_t i = 0; i < count; ++i)
+            out[i] = 0.0f;
+
+        for (uint32_t p = 0; p < kDecimation; ++p)
+        {
+            for (size_t q = 0; q < count + kDL3YResamplerTaps - 1; ++q)
+                phase[q] = x[p + q * kDecimation];
+
+            for (uint32_t m = 0; m < kDL3YResamplerTaps; ++m)
+            {
+                const float h = fDown[p + m * kDecimation];
+                const float* const __restrict xm = phase + m;
+
+                for (size_t i = 0; i < count; ++i)
+                    out[i] += h * xm[i];
+            }
+        }
+    }
+
+    // history holds the last kDL3YResamplerTaps decimated samples, followed by those of the chunk
+    void upChannel(float* const history, const float* const in, const uint32_t count, float* const out,
+                   const uint32_t frames) noexcept
+    {
+        const uint32_t keep = kDL3YResamplerTaps;
+        std::memcpy(history + keep, in, count * sizeof(float));
+
+        // frame t is phase (fPhase + t + 1) % decimation frames after the newest decimated sample, which
+        // is at keep - 1 + (fPhase + t + 1) / decimation in history; the frames of one phase share a filter
+        for (uint32_t p = 0; p < fDecimation; ++p)
+        {
+            const uint32_t first = (p + 2 * fDecimation - fPhase - 1) % fDecimation;
+
+            if (first >= frames)
+                continue;
+
+            const uint32_t n = (frames - first + fDecimation - 1) / fDecimation;
+            const float* const x = history + (fPhase + first + 1) / fDecimation;
+
+            upTaps(fUp[p], x, fScratch, n);
+
+            for (uint32_t m = 0; m < n; ++m)
+                out[first + m * fDecimation] = fScratch[m];
+        }
+
+        std::memmove(history, history + count, keep * sizeof(float));
+    }
+
+    static void upTaps(const float* const h, const float* const x, float* const __restrict out, const uint32_t n) noexcept
+    {
+        for (size_t m = 0; m < n; ++m)
+            out[m] = 0.0f;
+
+        for (uint32_t k = 0; k < kDL3YResamplerTaps; ++k)
+        {
+            const float hk = h[k];
+            const float* const __restrict xk = x + k;
+
+            for (size_t m = 0; m < n; ++m)
+                out[m] += hk * xk[m];
+        }
+    }
+
+    uint32_t fDecimation;
+    uint32_t fLength;
+    uint32_t fPhase;
+
+    float fDown[kMaxLength];
+    float fUp[kDL3YMaxDecimation][kDL3YResamplerTaps];
+
+    float fDownHistory[2][kMaxLength - 1 + kMaxFrames];
+    float fUpHistory[2][kDL3YResamplerTaps + kMaxFrames];
+    float fScratch[kMaxFrames + kDL3YResamplerTaps];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_RESAMPLER_HPP_INCLUDED
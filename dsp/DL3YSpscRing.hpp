@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_SPSC_RING_HPP_INCLUDED
+#define DL3Y_SPSC_RING_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Wait-free single producer, single consumer ring of fixed size.
+   push() when full and pop() when empty return false, neither ever blocks or allocates.
+ */
+template <typename T, uint32_t kCapacity>
+class DL3YSpscRing
+{
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    DL3YSpscRing() noexcept
+        : fWrite(0),
+          fRead(0) {}
+
+    bool push(const T& item) noexcept
+    {
+        const uint32_t write = fWrite.load(std::memory_order_relaxed);
+
+        if (write - fRead.load(std::memory_order_acquire) == kCapacity)
+            return false;
+
+        fItems[write & (kCapacity - 1)] = item;
+        fWrite.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) noexcept
+    {
+        const uint32_t read = fRead.load(std::memory_order_relaxed);
+
+        if (read == fWrite.load(std::memory_order_acquire))
+            return false;
+
+        item = fItems[read & (kCapacity - 1)];
+        fRead.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T fItems[kCapacity];
+    std::atomic<uint32_t> fWrite;
+    std::atomic<uint32_t> fRead;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_SPSC_RING_HPP_INCLUDED
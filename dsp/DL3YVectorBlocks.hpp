@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef DL3Y_VECTOR_BLOCKS_HPP_INCLUDED
+#define DL3Y_VECTOR_BLOCKS_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Runs a stereo processor that only takes whole vectors of kVector frames from kVector aligned
+   buffers, the Heavy context with HV_N_SIMD, on host buffers of any block size and alignment.
+
+   Heavy loads and stores its signal vectors with aligned SIMD instructions and leaves the frames
+   past the last whole vector of a block unprocessed. Here the processor sees the host's input
+   unchanged, nothing is padded, and its output reaches the host getLatency() = kVector - 1 frames
+   late:
+    - input frames that do not fill a whole vector wait in a FIFO for the next block
+    - output frames wait in a second FIFO, so every block hands back exactly as many frames as
+      it took; the two FIFOs always hold getLatency() frames together
+    - a block of whole vectors with nothing carried over runs in place on the host buffers when all
+      four are aligned, which is what hosts hand out at power of two block sizes; the output is
+      then moved by the latency, a memmove of the block, unless kVector is 1 and there is none
+    - anything else goes through an aligned scratch of kScratchFrames, chunk by chunk
+ */
+template <uint32_t kVector>
+class DL3YVectorBlocks
+{
+public:
+    static const uint32_t kScratchFrames = kVector > 64 ? kVector : 64;
+
+    DL3YVectorBlocks() noexcept
+    {
+        reset();
+    }
+
+    /**
+       Frames the output lags the input, constant.
+     */
+    static uint32_t getLatency() noexcept { return kVector - 1; }
+
+    /**
+       Drop the carried frames, the output starts with getLatency() frames of silence again.
+     */
+    void reset() noexcept
+    {
+        fPending = 0;
+        std::memset(fDelayed, 0, sizeof(fDelayed));
+    }
+
+    /**
+       Process frames of inputs into outputs, they may be the same buffers.
+       process(float** inputs, float** outputs, int frames) is only called with aligned buffers and
+       whole vectors.
+     */
+    template <typename Process>
+    void run(Process& process, const float* const* const inputs, float* const* const outputs, const uint32_t frames) noexcept
+    {
+        if (fPending == 0 && frames != 0 && frames % kVector == 0
+            && aligned(inputs[0]) && aligned(inputs[1]) && aligned(outputs[0]) && aligned(outputs[1]))
+        {
+            runInPlace(process, inputs, outputs, frames);
+            return;
+        }
+
+        for (uint32_t offset = 0; offset < frames;)
+        {
+            const uint32_t chunk = std::min(frames - offset, kScratchFrames - fPending);
+            runScratch(process, inputs, outputs, offset, chunk);
+            offset += chunk;
+        }
+    }
+
+private:
+    static bool aligned(const float* const buffer) noexcept
+    {
+        return (reinterpret_cast<uintptr_t>(buffer) & (kVector * sizeof(float) - 1)) == 0;
+    }
+
+    // nothing pending, so the output FIFO holds a full latency: the block's output is shifted by it
+    template <typename Process>
+    void runInPlace(Process& process, const float* const* const inputs, float* const* const outputs,
+                    const uint32_t frames) noexcept
+    {
+        const uint32_t latency = getLatency();
+        float* ins[2] = { const_cast<float*>(inputs[0]), const_cast<float*>(inputs[1]) };
+        process(ins, const_cast<float**>(outputs), (int)frames);
+
+        // scalar Heavy (HEAVY_SIMD=none), a constant the compiler folds
+        if (latency == 0)
+            return;
+
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            float tail[kVector];
+            std::memcpy(tail, outputs[c] + frames - latency, latency * sizeof(float));
+            std::memmove(outputs[c] + latency, outputs[c], (frames - latency) * sizeof(float));
+            std::memcpy(outputs[c], fDelayed[c], latency * sizeof(float));
+            std::memcpy(fDelayed[c], tail, latency * sizeof(float));
+        }
+    }
+
+    // frames of the host buffers at offset, after the pending input, through the scratch; frames is
+    // at most kScratchFrames - fPending
+    template <typename Process>
+    void runScratch(Process& process, const float* const* const inputs, float* const* const outputs,
+                    const uint32_t offset, const uint32_t frames) noexcept
+    {
+        float* const scratch = alignedScratch();
+        float* ins[2] = { scratch, scratch + kScratchFrames };
+        float* outs[2] = { scratch + 2 * kScratchFrames, scratch + 3 * kScratchFrames };
+
+        const uint32_t delayed = getLatency() - fPending;
+        const uint32_t total = fPending + frames;
+        const uint32_t whole = total - total % kVector;
+
+        // all inputs of the chunk are read before any output is written, they may be the same buffer
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            std::memcpy(ins[c], fPendingInput[c], fPending * sizeof(float));
+            std::memcpy(ins[c] + fPending, inputs[c] + offset, frames * sizeof(float));
+        }
+
+        if (whole != 0)
+            process(ins, outs, (int)whole);
+
+        // the output stream is the delayed frames followed by the processed ones, the first frames
+        // of it go to the host and the rest waits
+        const uint32_t fromDelayed = std::min(delayed, frames);
+        const uint32_t fromOutput = frames - fromDelayed;
+
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            std::memcpy(outputs[c] + offset, fDelayed[c], fromDelayed * sizeof(float));
+            std::memcpy(outputs[c] + offset + fromDelayed, outs[c], fromOutput * sizeof(float));
+
+            std::memmove(fDelayed[c], fDelayed[c] + fromDelayed, (delayed - fromDelayed) * sizeof(float));
+            std::memcpy(fDelayed[c] + delayed - fromDelayed, outs[c] + fromOutput, (whole - fromOutput) * sizeof(float));
+
+            std::memcpy(fPendingInput[c], ins[c] + whole, (total - whole) * sizeof(float));
+        }
+
+        fPending = total - whole;
+    }
+
+    // inputs then outputs, each row a multiple of kVector long; aligned by hand, as operator new of
+    // C++11 does not honour alignments beyond the fundamental one
+    float* alignedScratch() noexcept
+    {
+        const uintptr_t mask = kVector * sizeof(float) - 1;
+        return reinterpret_cast<float*>((reinterpret_cast<uintptr_t>(fScratch) + mask) & ~mask);
+    }
+
+    // input frames short of a whole vector, and processed frames not yet handed back
+    uint32_t fPending;
+    float fPendingInput[2][kVector];
+    float fDelayed[2][kVector];
+
+    float fScratch[4 * kScratchFrames + kVector];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // DL3Y_VECTOR_BLOCKS_HPP_INCLUDED
@@ -0,0 +1,488 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#include "HeavyDPF_WSTD_DL3Y.hpp"
+#include "HvHeavy.h"
+#include "DL3YParameters.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if DL3Y_NATIVE_DSP
+# include "extra/ScopedDenormalDisable.hpp"
+#endif
+
+
+START_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+struct ParameterInfo {
+    const char* receiver;
+    const char* name;
+    const char* symbol;
+    const char* unit;
+    uint32_t hints;
+    float min;
+    float max;
+    float def;
+};
+
+// receivers, ranges and defaults as declared with @hv_param in WSTD_DL3Y.pd
+static const ParameterInfo kParameterInfo[HeavyDPF_WSTD_DL3Y::paramCount] = {
+    { "High",          "High",           "high",           "dB", kParameterIsAutomatable,                            -15.0f,   15.0f,    0.0f },
+    { "High_Cross",    "High Cross",     "high_cross",     "",   kParameterIsAutomatable,                              0.0f,  100.0f,   20.0f },
+    { "High_Feedback", "High Feedback",  "high_feedback",  "",   kParameterIsAutomatable,                              0.0f,  100.0f,   25.0f },
+    { "High_Mix",      "High Mix",       "high_mix",       "",   kParameterIsAutomatable,                              0.0f,  100.0f,   50.0f },
+    { "High_Sync",     "High Sync",      "high_sync",      "",   kParameterIsAutomatable | kParameterIsBoolean,        0.0f,    1.0f,    0.0f },
+    { "High_Time",     "High Time",      "high_time",      "",   kParameterIsAutomatable,                             50.0f, 5000.0f,  500.0f },
+    { "High_TimeSync", "High TimeSync",  "high_timesync",  "",   kParameterIsAutomatable | kParameterIsInteger,        0.0f,   12.0f,    6.0f },
+    { "Low",           "Low",            "low",            "dB", kParameterIsAutomatable,                            -15.0f,   15.0f,    0.0f },
+    { "Low_Cross",     "Low Cross",      "low_cross",      "",   kParameterIsAutomatable,                              0.0f,  100.0f,   20.0f },
+    { "Low_Feedback",  "Low Feedback",   "low_feedback",   "",   kParameterIsAutomatable,                              0.0f,  100.0f,   25.0f },
+    { "Low_Mix",       "Low Mix",        "low_mix",        "",   kParameterIsAutomatable,                              0.0f,  100.0f,   50.0f },
+    { "Low_Sync",      "Low Sync",       "low_sync",       "",   kParameterIsAutomatable | kParameterIsBoolean,        0.0f,    1.0f,    0.0f },
+    { "Low_Time",      "Low Time",       "low_time",       "",   kParameterIsAutomatable,                             50.0f, 5000.0f,  500.0f },
+    { "Low_TimeSync",  "Low TimeSync",   "low_timesync",   "",   kParameterIsAutomatable | kParameterIsInteger,        0.0f,   12.0f,    6.0f },
+    { "Mid",           "Mid",            "mid",            "dB", kParameterIsAutomatable,                            -15.0f,   15.0f,    0.0f },
+    { "Mid_Cross",     "Mid Cross",      "mid_cross",      "",   kParameterIsAutomatable,                              0.0f,  100.0f,   20.0f },
+    { "Mid_Feedback",  "Mid Feedback",   "mid_feedback",   "",   kParameterIsAutomatable,                              0.0f,  100.0f,   25.0f },
+    { "Mid_Freq",      "Mid Freq",       "mid_freq",       "Hz", kParameterIsAutomatable | kParameterIsLogarithmic,  313.3f, 5705.6f, 1337.0f },
+    { "Mid_Mix",       "Mid Mix",        "mid_mix",        "",   kParameterIsAutomatable,                              0.0f,  100.0f,   50.0f },
+    { "Mid_Sync",      "Mid Sync",       "mid_sync",       "",   kParameterIsAutomatable | kParameterIsBoolean,        0.0f,    1.0f,    0.0f },
+    { "Mid_Time",      "Mid Time",       "mid_time",       "",   kParameterIsAutomatable,                             50.0f, 5000.0f,  500.0f },
+    { "Mid_TimeSync",  "Mid TimeSync",   "mid_timesync",   "",   kParameterIsAutomatable | kParameterIsInteger,        0.0f,   12.0f,    6.0f },
+    { "Quality",       "Quality",        "quality",        "",   kParameterIsAutomatable | kParameterIsInteger,        0.0f,    2.0f,    1.0f },
+};
+
+// labels as in the "enumerators" of WSTD_DL3Y.json, one per entry of kDL3YTimeSyncFactors
+static const char* const kTimeSyncLabels[kDL3YTimeSyncCount] = {
+    "×6", "×5", "×4", "×3", "×2", "×1.5", "×1", "÷1.5", "÷2", "÷3", "÷4", "÷5", "÷6"
+};
+static const uint32_t kTimeSyncCount = kDL3YTimeSyncCount;
+
+// labels as in the "Quality" enumerator of WSTD_DL3Y.json
+static const char* const kQualityLabels[] = { "Eco", "Normal", "High" };
+static const uint32_t kQualityCount = sizeof(kQualityLabels) / sizeof(kQualityLabels[0]);
+
+// -100 dBFS, anything below is considered silence
+static const float kSilenceThreshold = 1e-5f;
+
+// feedback at which a tail never decays below the silence threshold in practice
+static const float kMaxDecayingFeedback = 0.999f;
+
+// delay time ratio between two blocks taken as a jump of a state or preset load rather than automation
+static const double kStateLoadTimeRatio = 1.25;
+
+// feedback, time, sync and timesync parameters of each band
+static const uint32_t kBands[3][4] = {
+    { HeavyDPF_WSTD_DL3Y::paramHigh_Feedback, HeavyDPF_WSTD_DL3Y::paramHigh_Time,
+      HeavyDPF_WSTD_DL3Y::paramHigh_Sync, HeavyDPF_WSTD_DL3Y::paramHigh_TimeSync },
+    { HeavyDPF_WSTD_DL3Y::paramMid_Feedback, HeavyDPF_WSTD_DL3Y::paramMid_Time,
+      HeavyDPF_WSTD_DL3Y::paramMid_Sync, HeavyDPF_WSTD_DL3Y::paramMid_TimeSync },
+    { HeavyDPF_WSTD_DL3Y::paramLow_Feedback, HeavyDPF_WSTD_DL3Y::paramLow_Time,
+      HeavyDPF_WSTD_DL3Y::paramLow_Sync, HeavyDPF_WSTD_DL3Y::paramLow_TimeSync },
+};
+
+static bool isSilent(const float* const* buffers, uint32_t frames) noexcept
+{
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        const float* const buf = buffers[c];
+
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            if (std::fabs(buf[i]) > kSilenceThreshold)
+                return false;
+        }
+    }
+    return true;
+}
+
+#if DL3Y_LOAD_METER
+/**
+   Times the whole of run(), the stages in between are marked by processDSP() and the engine.
+ */
+struct ScopedLoadMeter {
+    ScopedLoadMeter(DL3YLoadMeter& m, const uint32_t f, const double sr) noexcept
+        : meter(m), frames(f), sampleRate(sr)
+    {
+        meter.begin();
+    }
+
+    ~ScopedLoadMeter() noexcept
+    {
+        meter.end(frames, sampleRate);
+    }
+
+    DL3YLoadMeter& meter;
+    const uint32_t frames;
+    const double sampleRate;
+};
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+HeavyDPF_WSTD_DL3Y::HeavyDPF_WSTD_DL3Y()
+    : Plugin(paramCount, 0, 0)
+{
+    for (uint32_t i = 0; i < paramCount; ++i)
+    {
+        _parameters[i] = kParameterInfo[i].def;
+        _sentParameters[i] = kParameterInfo[i].def;
+        _parameterHashes[i] = hv_stringToHash(kParameterInfo[i].receiver);
+    }
+    _bpmHash = hv_stringToHash("__hv_dpf_bpm");
+
+#if DL3Y_NATIVE_DSP
+    _engine = new DL3YEngine(getSampleRate());
+# if DL3Y_LOAD_METER
+    _engine->setLoadMeter(&_loadMeter);
+# endif
+#else
+    _context = new Heavy_WSTD_DL3Y(getSampleRate());
+# if DISTRHO_PLUGIN_WANT_LATENCY
+    setLatency(_vectorBlocks.getLatency());
+# endif
+#endif
+
+    // ensure that the new context has the current parameters
+    _dirtyParameters.store(kAllParameters);
+    updateTail();
+}
+
+HeavyDPF_WSTD_DL3Y::~HeavyDPF_WSTD_DL3Y()
+{
+#if DL3Y_NATIVE_DSP
+    delete _engine;
+#else
+    delete _context;
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Init
+
+void HeavyDPF_WSTD_DL3Y::initParameter(uint32_t index, Parameter& parameter)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index < paramCount,);
+
+    const ParameterInfo& info(kParameterInfo[index]);
+
+    parameter.name = info.name;
+    parameter.symbol = info.symbol;
+    parameter.unit = info.unit;
+    parameter.hints = info.hints;
+    parameter.ranges.min = info.min;
+    parameter.ranges.max = info.max;
+    parameter.ranges.def = info.def;
+
+    switch (index)
+    {
+    case paramHigh_TimeSync:
+    case paramMid_TimeSync:
+    case paramLow_TimeSync:
+        if (ParameterEnumerationValue *values = new ParameterEnumerationValue[kTimeSyncCount])
+        {
+            parameter.enumValues.restrictedMode = true;
+            for (uint32_t i = 0; i < kTimeSyncCount; ++i)
+            {
+                values[i].label = kTimeSyncLabels[i];
+                values[i].value = i;
+            }
+            parameter.enumValues.count = kTimeSyncCount;
+            parameter.enumValues.values = values;
+        }
+        break;
+
+    case paramQuality:
+        if (ParameterEnumerationValue *values = new ParameterEnumerationValue[kQualityCount])
+        {
+            parameter.enumValues.restrictedMode = true;
+            for (uint32_t i = 0; i < kQualityCount; ++i)
+            {
+                values[i].label = kQualityLabels[i];
+                values[i].value = i;
+            }
+            parameter.enumValues.count = kQualityCount;
+            parameter.enumValues.values = values;
+        }
+        break;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Internal data
+
+float HeavyDPF_WSTD_DL3Y::getParameterValue(uint32_t index) const
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index < paramCount, 0.0f);
+
+    return _parameters[index];
+}
+
+void HeavyDPF_WSTD_DL3Y::setParameterValue(uint32_t index, float value)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index < paramCount,);
+
+    _setParameters.fetch_or(1u << index, std::memory_order_relaxed);
+
+    if (_parameters[index] == value)
+        return;
+
+    // sent to the graph once at the start of the next block, however often the host sets it
+    _parameters[index] = value;
+    _dirtyParameters.fetch_or(1u << index, std::memory_order_release);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Process
+
+void HeavyDPF_WSTD_DL3Y::activate()
+{
+#if ! DL3Y_NATIVE_DSP
+    _vectorBlocks.reset();
+#endif
+    resetSilence();
+}
+
+void HeavyDPF_WSTD_DL3Y::hostTransportEvents(uint32_t)
+{
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    const TimePosition& timePos(getTimePosition());
+
+    if (timePos.bbt.valid && (! _bpmSent || d_isNotEqual(_bpm, (float)timePos.bbt.beatsPerMinute)))
+    {
+        _bpm = timePos.bbt.beatsPerMinute;
+        _bpmSent = true;
+#if DL3Y_NATIVE_DSP
+        _engine->setBpm(_bpm);
+#else
+        _context->sendFloatToReceiver(_bpmHash, _bpm);
+#endif
+        updateTail();
+    }
+#endif
+}
+
+void HeavyDPF_WSTD_DL3Y::sendParameters(const uint32_t dirty, const uint32_t set) noexcept
+{
+#if DL3Y_NATIVE_DSP
+    // A host restoring a state or preset sets every parameter between two blocks, and moves delay
+    // times further than automation does from one block to the next. Applied as one snapshot, the
+    // engine crossfades the delay taps instead of gliding every changed time. Hosts that send every
+    // parameter each block, or automate all of them, still glide while no time jumps.
+    if (set == kAllParameters && delayTimeJumped())
+    {
+        _engine->loadSnapshot(_parameters);
+        std::memcpy(_sentParameters, _parameters, sizeof(_parameters));
+        return;
+    }
+#else
+    (void)set;
+#endif
+
+    for (uint32_t i = 0; dirty >> i != 0; ++i)
+    {
+        if (dirty & (1u << i))
+        {
+#if DL3Y_NATIVE_DSP
+            _engine->setParameter(i, _parameters[i]);
+#else
+            _context->sendFloatToReceiver(_parameterHashes[i], _parameters[i]);
+#endif
+            _sentParameters[i] = _parameters[i];
+        }
+    }
+}
+
+#if DL3Y_NATIVE_DSP
+bool HeavyDPF_WSTD_DL3Y::delayTimeJumped() const noexcept
+{
+    const float beatMs = dl3yBeatMs(_bpm);
+
+    for (uint32_t b = 0; b < 3; ++b)
+    {
+        const uint32_t time = kBands[b][1], sync = kBands[b][2], timeSync = kBands[b][3];
+        const double sent = dl3yBandTimeMs(_sentParameters[time], _sentParameters[sync] != 0.0f, _sentParameters[timeSync], beatMs);
+        const double next = dl3yBandTimeMs(_parameters[time], _parameters[sync] != 0.0f, _parameters[timeSync], beatMs);
+
+        if (std::fmax(sent, next) > kStateLoadTimeRatio * std::fmin(sent, next))
+            return true;
+    }
+
+    return false;
+}
+#endif
+
+void HeavyDPF_WSTD_DL3Y::run(const float** inputs, float** outputs, uint32_t frames)
+{
+#if DL3Y_LOAD_METER
+    const ScopedLoadMeter slm(_loadMeter, frames, getSampleRate());
+#endif
+
+    hostTransportEvents(frames);
+
+    const uint32_t dirty = _dirtyParameters.exchange(0, std::memory_order_acquire);
+    const uint32_t set = _setParameters.exchange(0, std::memory_order_relaxed);
+
+    if (dirty != 0)
+    {
+        sendParameters(dirty, set);
+
+        // once per block however many parameters changed; one may make a frozen tail audible
+        // again (e.g. mix or amount raised), so wake up
+        updateTail();
+        resetSilence();
+    }
+
+    // While the input is silent and every feedback loop has decayed the graph is not run at all.
+    // The tail is considered gone once the output stayed silent for longer than the longest delay
+    // (nothing left in flight), or once the input was silent for the full computed tail length.
+    if (isSilent(inputs, frames))
+    {
+        if (_sleeping)
+        {
+            std::memset(outputs[0], 0, sizeof(float) * frames);
+            std::memset(outputs[1], 0, sizeof(float) * frames);
+            return;
+        }
+
+        processDSP(inputs, outputs, frames);
+
+        if (_silentInputFrames < kInfiniteTail - frames)
+            _silentInputFrames += frames;
+
+        if (! isSilent(outputs, frames))
+            _silentOutputFrames = 0;
+        else if (_silentOutputFrames < kInfiniteTail - frames)
+            _silentOutputFrames += frames;
+
+        if (_silentOutputFrames > _longestDelayFrames || (_tailFrames != kInfiniteTail && _silentInputFrames > _tailFrames))
+            _sleeping = true;
+    }
+    else
+    {
+        resetSilence();
+        processDSP(inputs, outputs, frames);
+    }
+}
+
+void HeavyDPF_WSTD_DL3Y::processDSP(const float** inputs, float** outputs, uint32_t frames) noexcept
+{
+#if DL3Y_NATIVE_DSP
+    exchangeLines();
+
+    const ScopedDenormalDisable sdd;
+# if DL3Y_LOAD_METER
+    _loadMeter.mark(kDL3YStageOutput);
+# endif
+    _engine->process(inputs, outputs, frames);
+#else
+    // heavy only takes whole vectors from aligned buffers, see DL3YVectorBlocks
+    HeavyContextInterface* const context = _context;
+    const auto process = [context](float** ins, float** outs, int n) { context->process(ins, outs, n); };
+    _vectorBlocks.run(process, inputs, outputs, frames);
+#endif
+}
+
+#if DL3Y_NATIVE_DSP
+void HeavyDPF_WSTD_DL3Y::exchangeLines() noexcept
+{
+    // lines for a new sample rate, the engine swaps them in once the old content has faded out;
+    // ones for a rate the engine has already left again go straight back
+    if (DL3YLineBuffer* const lines = _lineWorker.take())
+    {
+        if (! _engine->needsLines() || ! _engine->setLines(lines))
+            _lineWorker.retire(lines);
+    }
+
+    if (DL3YLineBuffer* const lines = _engine->takeRetiredLines())
+        _lineWorker.retire(lines);
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Callbacks
+
+void HeavyDPF_WSTD_DL3Y::sampleRateChanged(double newSampleRate)
+{
+#if DL3Y_NATIVE_DSP
+    // Some hosts change the rate of one plugin while others keep playing, so the large delay lines are
+    // not reallocated here: the engine follows at once and fades out the old content, new lines are
+    // prepared by the worker and picked up between blocks in run().
+    _engine->changeSampleRate(newSampleRate);
+    if (_engine->needsLines())
+        _lineWorker.request(newSampleRate);
+#else
+    delete _context;
+    _context = new Heavy_WSTD_DL3Y(newSampleRate);
+    _vectorBlocks.reset();
+#endif
+    _bpmSent = false;
+
+    // ensure that the new context has the current parameters
+    _dirtyParameters.store(kAllParameters);
+    updateTail();
+    resetSilence();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Silence detection
+
+void HeavyDPF_WSTD_DL3Y::resetSilence() noexcept
+{
+    _silentInputFrames = 0;
+    _silentOutputFrames = 0;
+    _sleeping = false;
+}
+
+double HeavyDPF_WSTD_DL3Y::getBandTimeMs(uint32_t timeParam, uint32_t syncParam, uint32_t timeSyncParam) const noexcept
+{
+    return dl3yBandTimeMs(_parameters[timeParam], _parameters[syncParam] != 0.0f, _parameters[timeSyncParam],
+                          dl3yBeatMs(_bpm));
+}
+
+void HeavyDPF_WSTD_DL3Y::updateTail() noexcept
+{
+    const double sampleRate = getSampleRate();
+    double longestDelay = 0.0;
+    double tail = 0.0;
+
+    for (uint32_t b = 0; b < 3; ++b)
+    {
+        const double delayFrames = getBandTimeMs(kBands[b][1], kBands[b][2], kBands[b][3]) * 0.001 * sampleRate;
+        const float feedback = _parameters[kBands[b][0]] * 0.01f;
+
+        longestDelay = std::fmax(longestDelay, delayFrames);
+
+        if (feedback >= kMaxDecayingFeedback)
+        {
+            tail = -1.0;
+            continue;
+        }
+
+        // first echo plus the repeats until the feedback loop decays below the threshold
+        const double repeats = feedback > kSilenceThreshold
+                             ? std::ceil(std::log(kSilenceThreshold) / std::log(feedback))
+                             : 0.0;
+
+        if (tail >= 0.0)
+            tail = std::fmax(tail, delayFrames * (1.0 + repeats));
+    }
+
+    _longestDelayFrames = (uint32_t)std::ceil(longestDelay);
+    _tailFrames = tail < 0.0 || tail >= (double)kInfiniteTail ? kInfiniteTail : (uint32_t)std::ceil(tail);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+Plugin* createPlugin()
+{
+    return new HeavyDPF_WSTD_DL3Y();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
@@ -0,0 +1,194 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef _HEAVY_DPF_WSTD_DL3Y_
+#define _HEAVY_DPF_WSTD_DL3Y_
+
+#include "DistrhoPlugin.hpp"
+#include "DistrhoPluginInfo.h"
+#include "Heavy_WSTD_DL3Y.hpp"
+
+#include <atomic>
+
+#if DL3Y_NATIVE_DSP
+# include "DL3YEngine.hpp"
+#else
+# include "DL3YVectorBlocks.hpp"
+# include "HvUtils.h"
+#endif
+
+#if DL3Y_LOAD_METER
+# if ! DL3Y_NATIVE_DSP
+#  error The load meter times the stages of the native engine, build with DL3Y_DSP=native
+# endif
+# if ! DISTRHO_PLUGIN_WANT_DIRECT_ACCESS
+#  error The load meter is read by the editor through DISTRHO_PLUGIN_WANT_DIRECT_ACCESS
+# endif
+#endif
+
+START_NAMESPACE_DISTRHO
+
+class HeavyDPF_WSTD_DL3Y : public Plugin
+{
+public:
+    enum Parameters
+    {
+        paramHigh,
+        paramHigh_Cross,
+        paramHigh_Feedback,
+        paramHigh_Mix,
+        paramHigh_Sync,
+        paramHigh_Time,
+        paramHigh_TimeSync,
+        paramLow,
+        paramLow_Cross,
+        paramLow_Feedback,
+        paramLow_Mix,
+        paramLow_Sync,
+        paramLow_Time,
+        paramLow_TimeSync,
+        paramMid,
+        paramMid_Cross,
+        paramMid_Feedback,
+        paramMid_Freq,
+        paramMid_Mix,
+        paramMid_Sync,
+        paramMid_Time,
+        paramMid_TimeSync,
+        paramQuality,
+        paramCount
+    };
+
+    HeavyDPF_WSTD_DL3Y();
+    ~HeavyDPF_WSTD_DL3Y() override;
+
+    void hostTransportEvents(uint32_t frames);
+
+#if DL3Y_LOAD_METER
+   /**
+      Per stage CPU load of run(), for the editor to read through direct access.
+    */
+    DL3YLoadMeter* getLoadMeter() noexcept { return &_loadMeter; }
+#endif
+
+protected:
+    // ----------------------------------------------------------------------------------------------------------------
+    // Information
+
+    const char* getLabel() const noexcept override
+    {
+        return "WSTD_DL3Y";
+    }
+
+    const char* getMaker() const noexcept override
+    {
+        return "Wasted Audio";
+    }
+
+    const char* getHomePage() const override
+    {
+        return "https://wasted.audio/software/wstd_dl3y";
+    }
+
+    const char* getLicense() const noexcept override
+    {
+        return "GPL-3.0-or-later";
+    }
+
+    uint32_t getVersion() const noexcept override
+    {
+        return d_version(1, 1, 1);
+    }
+
+    int64_t getUniqueId() const noexcept override
+    {
+        return d_cconst('D', 'l', '3', 'y');
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Init
+
+    void initParameter(uint32_t index, Parameter& parameter) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Internal data
+
+    float getParameterValue(uint32_t index) const override;
+    void  setParameterValue(uint32_t index, float value) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Process
+
+    void activate() override;
+    void run(const float** inputs, float** outputs, uint32_t frames) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Callbacks
+
+    void sampleRateChanged(double newSampleRate) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+
+private:
+    void sendParameters(uint32_t dirty, uint32_t set) noexcept;
+    void processDSP(const float** inputs, float** outputs, uint32_t frames) noexcept;
+#if DL3Y_NATIVE_DSP
+    void exchangeLines() noexcept;
+    bool delayTimeJumped() const noexcept;
+#endif
+    void resetSilence() noexcept;
+    void updateTail() noexcept;
+    double getBandTimeMs(uint32_t timeParam, uint32_t syncParam, uint32_t timeSyncParam) const noexcept;
+
+    // parameters, changes are flagged in _dirtyParameters and sent at the start of run();
+    // atomic as some formats (VST2, AU) set parameters from another thread than the audio one
+    static const uint32_t kAllParameters = (1u << paramCount) - 1;
+    float _parameters[paramCount];
+    hv_uint32_t _parameterHashes[paramCount];
+    std::atomic<uint32_t> _dirtyParameters { 0 };
+
+    // parameters the host set since the last block, changed or not; all of them along with a delay time
+    // jump means a state or preset load
+    std::atomic<uint32_t> _setParameters { 0 };
+
+    // values last sent to the DSP, what a jump is measured from
+    float _sentParameters[paramCount];
+
+    // transport values
+    hv_uint32_t _bpmHash;
+    float _bpm = 120.0f;
+    bool _bpmSent = false;
+
+    // silence detection; the tail is how long the output can stay audible after the input went
+    // silent, kInfiniteTail when a band feeds back at (nearly) 100%
+    static const uint32_t kInfiniteTail = 0xffffffff;
+    uint32_t _tailFrames = 0;
+    uint32_t _longestDelayFrames = 0;
+    uint32_t _silentInputFrames = 0;
+    uint32_t _silentOutputFrames = 0;
+    bool _sleeping = false;
+
+#if DL3Y_NATIVE_DSP
+    // native engine, the heavy graph is kept as the reference build (DL3Y_DSP=heavy)
+    DL3YEngine *_engine;
+
+    // prepares and frees the engine's delay lines off the audio thread
+    DL3YLineWorker _lineWorker;
+# if DL3Y_LOAD_METER
+    DL3YLoadMeter _loadMeter;
+# endif
+#else
+    // heavy context, run on the host buffers in whole aligned vectors, getLatency() frames late
+    HeavyContextInterface *_context;
+    DL3YVectorBlocks<HV_N_SIMD> _vectorBlocks;
+#endif
+
+    DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeavyDPF_WSTD_DL3Y)
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // _HEAVY_DPF_WSTD_DL3Y_
@@ -9,10 +9,118 @@
 #include "ResizeHandle.hpp"
 #include "veramobd.hpp"
 #include "wstdcolors.hpp"
+#include "DearImGui/imgui_internal.h"
+#include "DL3YLoadMeter.hpp"
+
+#if DL3Y_LOAD_METER
+# include "HeavyDPF_WSTD_DL3Y.hpp"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
 
 
 START_NAMESPACE_DISTRHO
 
+static const char* timesync_list[13] = {
+    "×6",
+    "×5",
+    "×4",
+    "×3",
+    "×2",
+    "×1.5",
+    "×1",
+    "÷1.5",
+    "÷2",
+    "÷3",
+    "÷4",
+    "÷5",
+    "÷6",
+};
+
+static const char* quality_list[3] = {
+    "Eco",
+    "Normal",
+    "High",
+};
+
+// repaints are batched to at most one per display frame
+static const double kRepaintInterval = 1.0 / 60.0;
+
+// long enough for the ImGui::Toggle slide animation to finish
+static const double kToggleAnimationTime = 0.25;
+
+#if DL3Y_LOAD_METER
+// the load readouts change a few times per second so they stay readable
+static const double kLoadRepaintInterval = 0.25;
+
+// how long a load peak is held before it falls back to the current peak
+static const double kLoadPeakHoldTime = 1.0;
+#endif
+
+static double getTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Font atlas shared by all editors in the process that use the same scale factor.
+   The font is decompressed and rasterized once, each editor only uploads its own texture.
+ */
+struct SharedFontAtlas {
+    ImFontAtlas* atlas;
+    ImFont* defaultFont;
+    ImFont* titleBarFont;
+    ImFont* smallFont;
+    int refCount;
+};
+
+static std::map<double, SharedFontAtlas> sharedFontAtlases;
+static std::mutex sharedFontAtlasesMutex;
+
+static SharedFontAtlas& acquireSharedFontAtlas(const double scaleFactor)
+{
+    const std::lock_guard<std::mutex> lock(sharedFontAtlasesMutex);
+
+    SharedFontAtlas& shared(sharedFontAtlases[scaleFactor]);
+
+    if (shared.refCount++ == 0)
+    {
+        ImFontConfig fc;
+        fc.FontDataOwnedByAtlas = true;
+        fc.OversampleH = 1;
+        fc.OversampleV = 1;
+        fc.PixelSnapH = true;
+
+        shared.atlas = IM_NEW(ImFontAtlas)();
+        shared.defaultFont  = shared.atlas->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 16.0f * scaleFactor, &fc);
+        shared.titleBarFont = shared.atlas->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 21.0f * scaleFactor, &fc);
+        shared.smallFont    = shared.atlas->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 11.0f * scaleFactor, &fc);
+        shared.atlas->Build();
+    }
+
+    return shared;
+}
+
+static void releaseSharedFontAtlas(const double scaleFactor)
+{
+    const std::lock_guard<std::mutex> lock(sharedFontAtlasesMutex);
+
+    std::map<double, SharedFontAtlas>::iterator it = sharedFontAtlases.find(scaleFactor);
+    DISTRHO_SAFE_ASSERT_RETURN(it != sharedFontAtlases.end(),);
+
+    if (--it->second.refCount == 0)
+    {
+        IM_DELETE(it->second.atlas);
+        sharedFontAtlases.erase(it);
+    }
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 class ImGuiPluginUI : public UI
 {
@@ -41,9 +149,49 @@ class ImGuiPluginUI : public UI
     float fmid_time = 500.0f;
     int fmid_timesync = 6;
 
+    int fquality = 1;
+
     int default_item_id = 6;
     int items_len = 13;
 
+    // widget values are sent once per frame, gestures only for the control being dragged
+    static const uint32_t kParameterCount = 23;
+    float pendingValues[kParameterCount];
+    uint32_t pendingMask = 0;
+    int gestureParameter = -1;
+
+    // derived colors, only recomputed when the amount, mix or mid freq values change
+    struct {
+        ImColor HighColorActive, HighColorHovered;
+        ImColor MidColorActive, MidColorHovered, MidFreqColorActive, MidFreqColorHovered;
+        ImColor LowColorActive, LowColorHovered;
+        ImColor HighMixActive, HighMixHovered, MidMixActive, MidMixHovered, LowMixActive, LowMixHovered;
+        ImColor HighSyncSw, HighSyncGr, HighSyncGrHovered, HighSyncAct, HighSyncActHovered;
+        ImColor MidSyncSw, MidSyncGr, MidSyncGrHovered, MidSyncAct, MidSyncActHovered;
+        ImColor LowSyncSw, LowSyncGr, LowSyncGrHovered, LowSyncAct, LowSyncActHovered;
+    } colors;
+
+    float colorsKey[7];
+    bool colorsValid = false;
+    bool repaintPending = false;
+    double lastRepaint = 0.0;
+    double animateUntil = 0.0;
+
+    // process-wide fonts, plus this editor's own texture of them
+    ImGuiContext* const context;
+    const double fontScaleFactor;
+    SharedFontAtlas& fonts;
+    ImTextureID fontTexture = ImTextureID();
+
+#if DL3Y_LOAD_METER
+    // load of the plugin's run(), only available when the host gives direct access to the plugin
+    DL3YLoadMeter* loadMeter = nullptr;
+    float loadAverage[kDL3YStageCount] = {};
+    float loadPeak[kDL3YStageCount] = {};
+    double loadPeakTime[kDL3YStageCount] = {};
+    double lastLoadRepaint = 0.0;
+#endif
+
     // ----------------------------------------------------------------------------------------------------------------
 
 public:
@@ -52,21 +200,34 @@ public:
       The UI should be initialized to a default state that matches the plugin side.
     */
     ImGuiPluginUI()
-        : UI(DISTRHO_UI_DEFAULT_WIDTH, DISTRHO_UI_DEFAULT_HEIGHT)
+        : UI(DISTRHO_UI_DEFAULT_WIDTH, DISTRHO_UI_DEFAULT_HEIGHT),
+          context(ImGui::GetCurrentContext()),
+          fontScaleFactor(getScaleFactor()),
+          fonts(acquireSharedFontAtlas(fontScaleFactor))
     {
-        ImGuiIO& io(ImGui::GetIO());
+        ImGuiIO& io(context->IO);
+
+        // swap the context's own atlas for the shared one, the context must not free it
+        if (context->FontAtlasOwnedByContext)
+            IM_DELETE(io.Fonts);
+        io.Fonts = fonts.atlas;
+        io.FontDefault = fonts.defaultFont;
+        context->FontAtlasOwnedByContext = false;
+
+#if DL3Y_LOAD_METER
+        if (HeavyDPF_WSTD_DL3Y* const plugin = static_cast<HeavyDPF_WSTD_DL3Y*>(getPluginInstancePointer()))
+            loadMeter = plugin->getLoadMeter();
+#endif
+    }
 
-        ImFontConfig fc;
-        fc.FontDataOwnedByAtlas = true;
-        fc.OversampleH = 1;
-        fc.OversampleV = 1;
-        fc.PixelSnapH = true;
+    ~ImGuiPluginUI() override
+    {
+        // hand the context a private atlas again, the backend still touches it on shutdown
+        context->IO.Fonts = IM_NEW(ImFontAtlas)();
+        context->IO.FontDefault = nullptr;
+        context->FontAtlasOwnedByContext = true;
 
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 16.0f * getScaleFactor(), &fc);
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 21.0f * getScaleFactor(), &fc);
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 11.0f * getScaleFactor(), &fc);
-        io.Fonts->Build();
-        io.FontDefault = io.Fonts->Fonts[1];
+        releaseSharedFontAtlas(fontScaleFactor);
     }
 
 protected:
@@ -146,10 +307,41 @@ protected:
             case 21:
                 fmid_timesync = value;
                 break;
+            case 22:
+                fquality = value;
+                break;
 
             default: return;
         }
 
+        if (index == 4 || index == 11 || index == 19)
+            animateUntil = getTime() + kToggleAnimationTime;
+
+        repaintPending = true;
+    }
+
+   /**
+      Idle callback, coalesces the repaints requested by parameter changes and toggle animations.
+      Nothing is drawn while the window is hidden or nothing changed.
+    */
+    void uiIdle() override
+    {
+        if (! isVisible())
+            return;
+
+        const double now = getTime();
+
+#if DL3Y_LOAD_METER
+        updateLoad(now);
+#endif
+
+        if (! repaintPending && now >= animateUntil)
+            return;
+        if (now - lastRepaint < kRepaintInterval)
+            return;
+
+        repaintPending = false;
+        lastRepaint = now;
         repaint();
     }
 
@@ -179,44 +371,18 @@ protected:
         style.Colors[ImGuiCol_WindowBg] = (ImVec4)WstdWindowBg;
 
         ImGuiIO& io(ImGui::GetIO());
-        ImFont* defaultFont = ImGui::GetFont();
-        ImFont* titleBarFont = io.Fonts->Fonts[2];
-        ImFont* smallFont = io.Fonts->Fonts[3];
-
-        // Colors
-        auto HighColorActive     = ColorBright(Blue,   fhigh);
-        auto HighColorHovered    = ColorBright(BlueBr, fhigh);
-        auto MidColorActive      =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
-        auto MidColorHovered     =    ColorMid(BlueBr, GreenBr, RedBr, fmid, fmid_freq);
-        auto MidFreqColorActive  =    ColorMid(BlueBr, GreenDr, RedBr, fmid, fmid_freq);
-        auto MidFreqColorHovered =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
-        auto LowColorActive      = ColorBright(Red,    flow);
-        auto LowColorHovered     = ColorBright(RedBr,  flow);
-
-        auto HighMixActive       = ColorMix(HighColorActive,  Yellow,   fhigh, fhigh_mix);
-        auto HighMixHovered      = ColorMix(HighColorHovered, YellowBr, fhigh, fhigh_mix);
-        auto MidMixActive        = ColorMix(MidColorActive,   Yellow,   fmid,  fmid_mix);
-        auto MidMixHovered       = ColorMix(MidColorHovered,  YellowBr, fmid,  fmid_mix);
-        auto LowMixActive        = ColorMix(LowColorActive,   Yellow,   flow,  flow_mix);
-        auto LowMixHovered       = ColorMix(LowColorHovered,  YellowBr, flow,  flow_mix);
-
-        auto HighSyncSw          = ColorBright(WhiteDr, fhigh, false);
-        auto HighSyncGr          = ColorBright(Grey, fhigh);
-        auto HighSyncGrHovered   = ColorBright(GreyBr, fhigh);
-        auto HighSyncAct         = ColorBright(BlueDr, fhigh);
-        auto HighSyncActHovered  = HighColorActive;
-
-        auto MidSyncSw           = ColorBright(WhiteDr, fmid, false);
-        auto MidSyncGr           = ColorBright(Grey, fmid);
-        auto MidSyncGrHovered    = ColorBright(GreyBr, fmid);
-        auto MidSyncAct          = MidFreqColorActive;
-        auto MidSyncActHovered   = MidColorActive;
-
-        auto LowSyncSw           = ColorBright(WhiteDr, flow, false);
-        auto LowSyncGr           = ColorBright(Grey, flow);
-        auto LowSyncGrHovered    = ColorBright(GreyBr, flow);
-        auto LowSyncAct          = ColorBright(RedDr, flow);
-        auto LowSyncActHovered   = LowColorActive;
+        ImFont* defaultFont = fonts.defaultFont;
+        ImFont* titleBarFont = fonts.titleBarFont;
+        ImFont* smallFont = fonts.smallFont;
+
+        // the backend uploaded the shared atlas into this editor's GL context on its first frame,
+        // other editors may have pointed the atlas at their own texture since
+        if (fontTexture == ImTextureID())
+            fontTexture = io.Fonts->TexID;
+        else
+            io.Fonts->SetTexID(fontTexture);
+
+        updateColors();
 
         // Sizes
         auto scaleFactor         = getScaleFactor();
@@ -241,22 +407,6 @@ protected:
             hzstep = 1.0f;
         }
 
-        const char* timesync_list[13] = {
-            "×6",
-            "×5",
-            "×4",
-            "×3",
-            "×2",
-            "×1.5",
-            "×1",
-            "÷1.5",
-            "÷2",
-            "÷3",
-            "÷4",
-            "÷5",
-            "÷6",
-        };
-
         ImGui::PushFont(titleBarFont);
         if (ImGui::Begin("WSTD DL3Y", nullptr, ImGuiWindowFlags_NoResize + ImGuiWindowFlags_NoCollapse))
         {
@@ -292,16 +442,37 @@ protected:
                 ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
                 ImGui::Dummy(ImVec2(0.0f, 38.0f) * scaleFactor);
                 CenterTextX("High", eqText);
-                ImGui::Dummy(ImVec2(0.0f, 80.0f) * scaleFactor);
+                ImGui::Dummy(ImVec2(0.0f, 80.0f * scaleFactor - loadReadout(kDL3YStageHigh, eqText)));
                 CenterTextX("Mid", eqText);
-                ImGui::Dummy(ImVec2(0.0f, 60.0f) * scaleFactor);
+                ImGui::Dummy(ImVec2(0.0f, 60.0f * scaleFactor - loadReadout(kDL3YStageMid, eqText)));
                 ImGui::PushFont(smallFont);
                 CenterTextX("Mid", eqText);
                 CenterTextX("Freq", eqText);
                 ImGui::PopFont();
                 ImGui::Dummy(ImVec2(0.0f, 60.0f) * scaleFactor);
                 CenterTextX("Low", eqText);
+                loadReadout(kDL3YStageLow, eqText);
                 ImGui::PopStyleColor();
+
+                // quality, steps through Eco / Normal / High on click
+                ImGui::Dummy(ImVec2(0.0f, 20.0f) * scaleFactor);
+                ImGui::PushFont(smallFont);
+                ImGui::PushStyleColor(ImGuiCol_Text,            TextClr);
+                ImGui::PushStyleColor(ImGuiCol_Button,          ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)Grey);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)GreyBr);
+                char qualityLabel[24];
+                std::snprintf(qualityLabel, sizeof(qualityLabel), "%s###Quality", quality_list[fquality]);
+                if (ImGui::Button(qualityLabel, ImVec2(eqText, 0.0f)))
+                {
+                    fquality = (fquality + 1) % 3;
+                    queueParameterValue(22, fquality);
+                }
+                trackGesture(22);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Quality");
+                ImGui::PopStyleColor(4);
+                ImGui::PopFont();
             }
             ImGui::EndGroup();
             ImGui::SameLine();
@@ -309,62 +480,49 @@ protected:
             // EQ Section
             ImGui::BeginGroup();
             {
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighColorHovered);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.HighColorActive);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.HighColorHovered);
                 if (ImGuiKnobs::Knob("High", &fhigh, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
                 {
-
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(0, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fhigh = 0.0f;
-                    }
-                    setParameterValue(0, fhigh);
+                    if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                        fhigh = 0.0f;
+                    queueParameterValue(0, fhigh);
                 }
+                trackGesture(0);
                 ImGui::PopStyleColor(2);
 
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidColorHovered);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.MidColorActive);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.MidColorHovered);
                 if (ImGuiKnobs::Knob("Mid", &fmid, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
                 {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(14, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fmid = 0.0f;
-                    }
-                    setParameterValue(14, fmid);
+                    if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                        fmid = 0.0f;
+                    queueParameterValue(14, fmid);
                 }
+                trackGesture(14);
                 ImGui::PopStyleColor(2);
 
                 ImGui::Dummy(ImVec2(7.5f, 0.0f) * getScaleFactor()); ImGui::SameLine();
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidFreqColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidFreqColorHovered);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.MidFreqColorActive);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.MidFreqColorHovered);
                 if (ImGuiKnobs::Knob("Mid Freq", &fmid_freq, 313.3f, 5705.6f, hzstep, "%.1fHz", ImGuiKnobVariant_SteppedTick, seventy, ImGuiKnob_FlagsLog, 11))
                 {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(17, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fmid_freq = 1337.0f;
-                    }
-                    setParameterValue(17, fmid_freq);
+                    if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                        fmid_freq = 1337.0f;
+                    queueParameterValue(17, fmid_freq);
                 }
+                trackGesture(17);
                 ImGui::PopStyleColor(2);
 
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowColorHovered);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.LowColorActive);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.LowColorHovered);
                 if (ImGuiKnobs::Knob("Low", &flow, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
                 {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(7, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            flow = 0.0f;
-                    }
-                    setParameterValue(7, flow);
+                    if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                        flow = 0.0f;
+                    queueParameterValue(7, flow);
                 }
+                trackGesture(7);
                 ImGui::PopStyleColor(2);
             }
             ImGui::EndGroup(); ImGui::SameLine();
@@ -375,22 +533,19 @@ protected:
             {
                 ImGui::BeginGroup();
                 {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighColorHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.HighColorActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.HighColorHovered);
                     if (not fhigh_sync)
                     {
                         if (ImGuiKnobs::Knob(
                             "High Time", &fhigh_time, 50.0f, 5000.0f, msstep, "%.0fms",
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsLog, 21))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(5, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    fhigh_time = 500.0f;
-                            }
-                            setParameterValue(5, fhigh_time);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                fhigh_time = 500.0f;
+                            queueParameterValue(5, fhigh_time);
                         }
+                        trackGesture(5);
                     }
 
                     if (fhigh_sync)
@@ -399,16 +554,11 @@ protected:
                             "High TimeSync", &fhigh_timesync, 0, items_len-1, syncstep, timesync_list[fhigh_timesync],
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, items_len))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(6, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                {
-                                    fhigh_timesync = default_item_id;
-                                }
-                            }
-                            setParameterValue(6, fhigh_timesync);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                fhigh_timesync = default_item_id;
+                            queueParameterValue(6, fhigh_timesync);
                         }
+                        trackGesture(6);
                     }
                     ImGui::SameLine();
 
@@ -417,23 +567,21 @@ protected:
                         ImGui::Dummy(ImVec2(0.0f, 35.0f) * scaleFactor);
 
                         // knob
-                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)HighSyncSw);
+                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)colors.HighSyncSw);
 
                         // inactive colors
-                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)HighSyncGr);
-                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)HighSyncGrHovered);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)colors.HighSyncGr);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)colors.HighSyncGrHovered);
 
                         // active colors
-                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)HighSyncAct);
-                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighSyncActHovered);
+                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)colors.HighSyncAct);
+                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.HighSyncActHovered);
                         if (ImGui::Toggle("##High Sync", &fhigh_sync, ImGuiToggleFlags_Animated))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(4, true);
-                                setParameterValue(4, fhigh_sync);
-                            }
+                            queueParameterValue(4, fhigh_sync);
+                            animateUntil = getTime() + kToggleAnimationTime;
                         }
+                        trackGesture(4);
                         ImGui::PopStyleColor(5);
                     }
                     ImGui::EndGroup();
@@ -441,41 +589,32 @@ protected:
 
                     if (ImGuiKnobs::Knob("High Feedback", &fhigh_feedback, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_Space, hundred, ImGuiKnob_Flags))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(2, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_feedback = 25.0f;
-                        }
-                        setParameterValue(2, fhigh_feedback);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fhigh_feedback = 25.0f;
+                        queueParameterValue(2, fhigh_feedback);
                     }
+                    trackGesture(2);
                     ImGui::SameLine();
 
                     if (ImGuiKnobs::Knob("High Cross", &fhigh_cross, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(1, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_cross = 20.0f;
-                        }
-                        setParameterValue(1, fhigh_cross);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fhigh_cross = 20.0f;
+                        queueParameterValue(1, fhigh_cross);
                     }
+                    trackGesture(1);
                     ImGui::PopStyleColor(2);
                     ImGui::SameLine();
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighMixHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.HighMixActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.HighMixHovered);
                     if (ImGuiKnobs::Knob("High Mix", &fhigh_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(3, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_mix = 50.0f;
-                        }
-                        setParameterValue(3, fhigh_mix);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fhigh_mix = 50.0f;
+                        queueParameterValue(3, fhigh_mix);
                     }
+                    trackGesture(3);
                     ImGui::PopStyleColor(2);
                 }
                 ImGui::EndGroup();
@@ -483,22 +622,19 @@ protected:
                 // Mid Band
                 ImGui::BeginGroup();
                 {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidColorHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.MidColorActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.MidColorHovered);
                     if (not fmid_sync)
                     {
                         if (ImGuiKnobs::Knob(
                             "Mid Time", &fmid_time, 50.0f, 5000.0f, msstep, "%.0fms",
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsLog, 21))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(20, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    fmid_time = 500.0f;
-                            }
-                            setParameterValue(20, fmid_time);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                fmid_time = 500.0f;
+                            queueParameterValue(20, fmid_time);
                         }
+                        trackGesture(20);
                     }
 
                     if (fmid_sync)
@@ -507,16 +643,11 @@ protected:
                             "Mid TimeSync", &fmid_timesync, 0, items_len-1, syncstep, timesync_list[fmid_timesync],
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, items_len))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(21, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                {
-                                    fmid_timesync = default_item_id;
-                                }
-                            }
-                            setParameterValue(21, fmid_timesync);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                fmid_timesync = default_item_id;
+                            queueParameterValue(21, fmid_timesync);
                         }
+                        trackGesture(21);
                     }
                     ImGui::SameLine();
 
@@ -525,23 +656,21 @@ protected:
                         ImGui::Dummy(ImVec2(0.0f, 35.0f) * scaleFactor);
 
                         // knob
-                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)MidSyncSw);
+                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)colors.MidSyncSw);
 
                         // inactive colors
-                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)MidSyncGr);
-                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)MidSyncGrHovered);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)colors.MidSyncGr);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)colors.MidSyncGrHovered);
 
                         // active colors
-                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)MidSyncAct);
-                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidSyncActHovered);
+                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)colors.MidSyncAct);
+                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.MidSyncActHovered);
                         if (ImGui::Toggle("##Mid Sync", &fmid_sync, ImGuiToggleFlags_Animated))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(19, true);
-                                setParameterValue(19, fmid_sync);
-                            }
+                            queueParameterValue(19, fmid_sync);
+                            animateUntil = getTime() + kToggleAnimationTime;
                         }
+                        trackGesture(19);
                         ImGui::PopStyleColor(5);
                     }
                     ImGui::EndGroup();
@@ -549,41 +678,32 @@ protected:
 
                     if (ImGuiKnobs::Knob("Mid Feedback", &fmid_feedback, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_Space, hundred, ImGuiKnob_Flags))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(16, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_feedback = 25.0f;
-                        }
-                        setParameterValue(16, fmid_feedback);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fmid_feedback = 25.0f;
+                        queueParameterValue(16, fmid_feedback);
                     }
+                    trackGesture(16);
                     ImGui::SameLine();
 
                     if (ImGuiKnobs::Knob("Mid Cross", &fmid_cross, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(15, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_cross = 20.0f;
-                        }
-                        setParameterValue(15, fmid_cross);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fmid_cross = 20.0f;
+                        queueParameterValue(15, fmid_cross);
                     }
+                    trackGesture(15);
                     ImGui::PopStyleColor(2);
                     ImGui::SameLine();
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidMixHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.MidMixActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.MidMixHovered);
                     if (ImGuiKnobs::Knob("Mid Mix", &fmid_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(18, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_mix = 50.0f;
-                        }
-                        setParameterValue(18, fmid_mix);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            fmid_mix = 50.0f;
+                        queueParameterValue(18, fmid_mix);
                     }
+                    trackGesture(18);
                     ImGui::PopStyleColor(2);
                 }
                 ImGui::EndGroup();
@@ -606,22 +726,19 @@ protected:
                 // Low Band
                 ImGui::BeginGroup();
                 {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowColorHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.LowColorActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.LowColorHovered);
                     if (not flow_sync)
                     {
                         if (ImGuiKnobs::Knob(
                             "Low Time", &flow_time, 50.0f, 5000.0f, msstep, "%.0fms",
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsLog, 21))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(12, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    flow_time = 500.0f;
-                            }
-                            setParameterValue(12, flow_time);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                flow_time = 500.0f;
+                            queueParameterValue(12, flow_time);
                         }
+                        trackGesture(12);
                     }
 
                     if (flow_sync)
@@ -630,16 +747,11 @@ protected:
                             "Low TimeSync", &flow_timesync, 0, items_len-1, syncstep, timesync_list[flow_timesync],
                             ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, items_len))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(13, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                {
-                                    flow_timesync = default_item_id;
-                                }
-                            }
-                            setParameterValue(13, flow_timesync);
+                            if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                                flow_timesync = default_item_id;
+                            queueParameterValue(13, flow_timesync);
                         }
+                        trackGesture(13);
                     }
                     ImGui::SameLine();
 
@@ -648,23 +760,21 @@ protected:
                         ImGui::Dummy(ImVec2(0.0f, 35.0f) * scaleFactor);
 
                         // knob
-                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)LowSyncSw);
+                        ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)colors.LowSyncSw);
 
                         // inactive colors
-                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)LowSyncGr);
-                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)LowSyncGrHovered);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)colors.LowSyncGr);
+                        ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)colors.LowSyncGrHovered);
 
                         // active colors
-                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)LowSyncAct);
-                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowSyncActHovered);
+                        ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)colors.LowSyncAct);
+                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.LowSyncActHovered);
                         if (ImGui::Toggle("##Low Sync", &flow_sync, ImGuiToggleFlags_Animated))
                         {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(11, true);
-                                setParameterValue(11, flow_sync);
-                            }
+                            queueParameterValue(11, flow_sync);
+                            animateUntil = getTime() + kToggleAnimationTime;
                         }
+                        trackGesture(11);
                         ImGui::PopStyleColor(5);
                     }
                     ImGui::EndGroup();
@@ -672,78 +782,225 @@ protected:
 
                     if (ImGuiKnobs::Knob("Low Feedback", &flow_feedback, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_Space, hundred, ImGuiKnob_Flags))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(9, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_feedback = 25.0f;
-
-                        }
-                        setParameterValue(9, flow_feedback);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            flow_feedback = 25.0f;
+                        queueParameterValue(9, flow_feedback);
                     }
+                    trackGesture(9);
                     ImGui::SameLine();
 
                     if (ImGuiKnobs::Knob("Low Cross", &flow_cross, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(8, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_cross = 20.0f;
-                        }
-                        setParameterValue(8, flow_cross);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            flow_cross = 20.0f;
+                        queueParameterValue(8, flow_cross);
                     }
+                    trackGesture(8);
                     ImGui::PopStyleColor(2);
                     ImGui::SameLine();
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowMixHovered);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.LowMixActive);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.LowMixHovered);
                     if (ImGuiKnobs::Knob("Low Mix", &flow_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(10, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_mix = 50.0f;
-                        }
-                        setParameterValue(10, flow_mix);
+                        if (ImGui::IsItemActivated() && ImGui::IsMouseDoubleClicked(0))
+                            flow_mix = 50.0f;
+                        queueParameterValue(10, flow_mix);
                     }
+                    trackGesture(10);
                     ImGui::PopStyleColor(2);
                 }
                 ImGui::EndGroup();
             }
             ImGui::EndGroup();
 
-            if (ImGui::IsItemDeactivated())
-            {
-                editParameter(0, false);
-                editParameter(1, false);
-                editParameter(2, false);
-                editParameter(3, false);
-                editParameter(4, false);
-                editParameter(5, false);
-                editParameter(6, false);
-                editParameter(7, false);
-                editParameter(8, false);
-                editParameter(9, false);
-                editParameter(10, false);
-                editParameter(11, false);
-                editParameter(12, false);
-                editParameter(13, false);
-                editParameter(14, false);
-                editParameter(15, false);
-                editParameter(16, false);
-                editParameter(17, false);
-                editParameter(18, false);
-                editParameter(19, false);
-                editParameter(20, false);
-                editParameter(21, false);
-            }
-
             ImGui::PopFont();
         }
         ImGui::PopFont();
         ImGui::End();
+
+        flushParameters();
+    }
+
+private:
+    // ----------------------------------------------------------------------------------------------------------------
+    // Helpers
+
+    void queueParameterValue(uint32_t index, float value)
+    {
+        pendingValues[index] = value;
+        pendingMask |= 1u << index;
+    }
+
+   /**
+      Begin a host gesture when the last submitted widget was just grabbed.
+      Called right after each widget, it is ended again in flushParameters().
+    */
+    void trackGesture(uint32_t index)
+    {
+        if (! ImGui::IsItemActivated())
+            return;
+
+        if (gestureParameter >= 0)
+            editParameter(gestureParameter, false);
+
+        editParameter(index, true);
+        gestureParameter = index;
+    }
+
+   /**
+      Send this frame's widget values, then end the gesture once nothing is held anymore.
+      This also covers a widget that disappeared while dragged (e.g. Time/TimeSync on a sync switch).
+    */
+    void flushParameters()
+    {
+        for (uint32_t i = 0; i < kParameterCount; ++i)
+        {
+            if (pendingMask & (1u << i))
+                setParameterValue(i, pendingValues[i]);
+        }
+        pendingMask = 0;
+
+        if (gestureParameter >= 0 && ! ImGui::IsAnyItemActive())
+        {
+            editParameter(gestureParameter, false);
+            gestureParameter = -1;
+        }
+    }
+
+   /**
+      Average / peak load of one band in two small lines, returns the height they took.
+      Hovering shows all stages of run(). Nothing is drawn without the load meter.
+    */
+    float loadReadout(DL3YLoadStage stage, float width)
+    {
+#if DL3Y_LOAD_METER
+        if (loadMeter == nullptr)
+            return 0.0f;
+
+        const float y = ImGui::GetCursorPosY();
+        char text[16];
+
+        ImGui::PushFont(fonts.smallFont);
+        ImGui::BeginGroup();
+        std::snprintf(text, sizeof(text), "%.1f%%", loadAverage[stage]);
+        CenterTextX(text, width);
+        std::snprintf(text, sizeof(text), "^%.1f%%", loadPeak[stage]);
+        CenterTextX(text, width);
+        ImGui::EndGroup();
+        ImGui::PopFont();
+
+        if (ImGui::IsItemHovered())
+        {
+            float total = 0.0f;
+            for (uint32_t s = 0; s < kDL3YStageCount; ++s)
+                total += loadAverage[s];
+
+            ImGui::SetTooltip("average / peak CPU of the audio block budget\n"
+                              "crossover %5.2f%% / %5.2f%%\n"
+                              "high      %5.2f%% / %5.2f%%\n"
+                              "mid       %5.2f%% / %5.2f%%\n"
+                              "low       %5.2f%% / %5.2f%%\n"
+                              "output    %5.2f%% / %5.2f%%\n"
+                              "total     %5.2f%%",
+                              loadAverage[kDL3YStageCrossover], loadPeak[kDL3YStageCrossover],
+                              loadAverage[kDL3YStageHigh], loadPeak[kDL3YStageHigh],
+                              loadAverage[kDL3YStageMid], loadPeak[kDL3YStageMid],
+                              loadAverage[kDL3YStageLow], loadPeak[kDL3YStageLow],
+                              loadAverage[kDL3YStageOutput], loadPeak[kDL3YStageOutput],
+                              total);
+        }
+
+        return ImGui::GetCursorPosY() - y;
+#else
+        (void)stage;
+        (void)width;
+        return 0.0f;
+#endif
+    }
+
+#if DL3Y_LOAD_METER
+   /**
+      Drain the load frames published by the audio thread.
+      The average is smoothed over the last frames, peaks are held for kLoadPeakHoldTime.
+    */
+    void updateLoad(double now)
+    {
+        if (loadMeter == nullptr)
+            return;
+
+        DL3YLoadFrame frame;
+        bool changed = false;
+
+        while (loadMeter->read(frame))
+        {
+            for (uint32_t s = 0; s < kDL3YStageCount; ++s)
+            {
+                loadAverage[s] += 0.1f * (frame.average[s] - loadAverage[s]);
+
+                if (frame.peak[s] >= loadPeak[s] || now - loadPeakTime[s] > kLoadPeakHoldTime)
+                {
+                    loadPeak[s] = frame.peak[s];
+                    loadPeakTime[s] = now;
+                }
+            }
+            changed = true;
+        }
+
+        if (changed && now - lastLoadRepaint >= kLoadRepaintInterval)
+        {
+            lastLoadRepaint = now;
+            repaintPending = true;
+        }
+    }
+#endif
+
+   /**
+      Recompute the derived colors, only when one of the parameters they depend on changed.
+    */
+    void updateColors()
+    {
+        const float key[7] = { fhigh, fhigh_mix, fmid, fmid_freq, fmid_mix, flow, flow_mix };
+
+        if (colorsValid && std::memcmp(key, colorsKey, sizeof(key)) == 0)
+            return;
+
+        std::memcpy(colorsKey, key, sizeof(key));
+        colorsValid = true;
+
+        colors.HighColorActive     = ColorBright(Blue,   fhigh);
+        colors.HighColorHovered    = ColorBright(BlueBr, fhigh);
+        colors.MidColorActive      =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
+        colors.MidColorHovered     =    ColorMid(BlueBr, GreenBr, RedBr, fmid, fmid_freq);
+        colors.MidFreqColorActive  =    ColorMid(BlueBr, GreenDr, RedBr, fmid, fmid_freq);
+        colors.MidFreqColorHovered =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
+        colors.LowColorActive      = ColorBright(Red,    flow);
+        colors.LowColorHovered     = ColorBright(RedBr,  flow);
+
+        colors.HighMixActive       = ColorMix(colors.HighColorActive,  Yellow,   fhigh, fhigh_mix);
+        colors.HighMixHovered      = ColorMix(colors.HighColorHovered, YellowBr, fhigh, fhigh_mix);
+        colors.MidMixActive        = ColorMix(colors.MidColorActive,   Yellow,   fmid,  fmid_mix);
+        colors.MidMixHovered       = ColorMix(colors.MidColorHovered,  YellowBr, fmid,  fmid_mix);
+        colors.LowMixActive        = ColorMix(colors.LowColorActive,   Yellow,   flow,  flow_mix);
+        colors.LowMixHovered       = ColorMix(colors.LowColorHovered,  YellowBr, flow,  flow_mix);
+
+        colors.HighSyncSw          = ColorBright(WhiteDr, fhigh, false);
+        colors.HighSyncGr          = ColorBright(Grey, fhigh);
+        colors.HighSyncGrHovered   = ColorBright(GreyBr, fhigh);
+        colors.HighSyncAct         = ColorBright(BlueDr, fhigh);
+        colors.HighSyncActHovered  = colors.HighColorActive;
+
+        colors.MidSyncSw           = ColorBright(WhiteDr, fmid, false);
+        colors.MidSyncGr           = ColorBright(Grey, fmid);
+        colors.MidSyncGrHovered    = ColorBright(GreyBr, fmid);
+        colors.MidSyncAct          = colors.MidFreqColorActive;
+        colors.MidSyncActHovered   = colors.MidColorActive;
+
+        colors.LowSyncSw           = ColorBright(WhiteDr, flow, false);
+        colors.LowSyncGr           = ColorBright(Grey, flow);
+        colors.LowSyncGrHovered    = ColorBright(GreyBr, flow);
+        colors.LowSyncAct          = ColorBright(RedDr, flow);
+        colors.LowSyncActHovered   = colors.LowColorActive;
     }
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImGuiPluginUI)
@@ -0,0 +1,660 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Offline renderer: WAV files through DL3YEngine with one fixed parameter set, on all cores.
+
+       WSTD_DL3Y_render [-p Name=value]... [-b bpm] [-t seconds] [-o directory] [-j threads] [-f] file.wav...
+
+    -p  a parameter by its @hv_param receiver name (High_Mix=35, Mid_Sync=1, Quality=2, ...),
+        unset parameters keep their defaults
+    -b  tempo for the synced delay times (__hv_dpf_bpm), default 120
+    -t  seconds of tail rendered after the end of each input, default 0
+    -o  output directory, default next to each input; outputs are named <input>_dl3y.wav
+    -j  worker threads, default one per core
+    -f  write 32-bit float instead of the input's sample format
+
+   Inputs are 16, 24 or 32-bit integer or 32 / 64-bit float WAV, mono or stereo; mono is fed to both
+   inputs, outputs are always stereo. Input and output files are memory-mapped, each worker converts
+   blocks straight from and to the mappings. Every file is one task, handed out through a work-stealing
+   queue, largest files first; a worker keeps its engine and sets it up for each file's sample rate
+   with the parameters already in place, so every file starts settled on them.
+
+   POSIX only (mmap), built with `make render`.
+ */
+
+#include "DL3YEngine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE__) || defined(__x86_64__)
+# include <xmmintrin.h>
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+// frames converted and processed per engine call
+static const uint32_t kRenderBlock = 4096;
+
+enum SampleFormat {
+    kFormatInt16,
+    kFormatInt24,
+    kFormatInt32,
+    kFormatFloat32,
+    kFormatFloat64
+};
+
+static const uint32_t kBytesPerSample[] = { 2, 3, 4, 4, 8 };
+
+struct RenderSettings {
+    float parameters[kDL3YParameterCount];
+    float bpm;
+    double tailSeconds;
+    std::string outputDirectory;
+    bool floatOutput;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   A whole file mapped into memory, read-only or created with a given size for writing.
+ */
+class MappedFile
+{
+public:
+    MappedFile()
+        : fData(nullptr),
+          fSize(0) {}
+
+    ~MappedFile()
+    {
+        if (fData != nullptr)
+            munmap(fData, fSize);
+    }
+
+    bool openRead(const std::string& path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        fSize = (size_t)st.st_size;
+        void* const data = mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+            return false;
+
+        fData = (uint8_t*)data;
+        madvise(fData, fSize, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    bool create(const std::string& path, const size_t size)
+    {
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+
+        if (ftruncate(fd, (off_t)size) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        fSize = size;
+        void* const data = mmap(nullptr, fSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+            return false;
+
+        fData = (uint8_t*)data;
+        return true;
+    }
+
+    uint8_t* data() const noexcept { return fData; }
+    size_t size() const noexcept { return fSize; }
+
+private:
+    uint8_t* fData;
+    size_t fSize;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// WAV
+
+struct WavInfo {
+    SampleFormat format;
+    uint32_t channels;
+    uint32_t sampleRate;
+    const uint8_t* samples;
+    size_t frames;
+};
+
+static uint16_t readLE16(const uint8_t* const p) noexcept { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t readLE32(const uint8_t* const p) noexcept { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+static void writeLE16(uint8_t* const p, const uint32_t v) noexcept { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void writeLE32(uint8_t* const p, const uint32_t v) noexcept { writeLE16(p, v); writeLE16(p + 2, v >> 16); }
+
+/**
+   Find the fmt and data chunks of a RIFF WAVE file. Returns nullptr or the reason it cannot be read.
+ */
+static const char* parseWav(const uint8_t* const bytes, const size_t size, WavInfo& info)
+{
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0)
+        return "not a RIFF WAVE file";
+
+    bool haveFormat = false;
+    uint16_t tag = 0, bits = 0;
+
+    for (size_t pos = 12; pos + 8 <= size;)
+    {
+        const uint8_t* const chunk = bytes + pos;
+        const size_t chunkSize = readLE32(chunk + 4);
+        const size_t available = std::min(chunkSize, size - pos - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            tag = readLE16(chunk + 8);
+            info.channels = readLE16(chunk + 10);
+            info.sampleRate = readLE32(chunk + 12);
+            bits = readLE16(chunk + 22);
+
+            // WAVE_FORMAT_EXTENSIBLE, the sub format GUID starts with the format tag
+            if (tag == 0xfffe && available >= 40)
+                tag = readLE16(chunk + 32);
+
+            haveFormat = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (! haveFormat)
+                return "data chunk before fmt chunk";
+
+            if (tag == 1 && bits == 16)
+                info.format = kFormatInt16;
+            else if (tag == 1 && bits == 24)
+                info.format = kFormatInt24;
+            else if (tag == 1 && bits == 32)
+                info.format = kFormatInt32;
+            else if (tag == 3 && bits == 32)
+                info.format = kFormatFloat32;
+            else if (tag == 3 && bits == 64)
+                info.format = kFormatFloat64;
+            else
+                return "unsupported sample format";
+
+            if (info.channels != 1 && info.channels != 2)
+                return "only mono and stereo files are supported";
+            if (info.sampleRate == 0)
+                return "invalid sample rate";
+
+            // a truncated last chunk is read as far as it goes
+            info.samples = chunk + 8;
+            info.frames = available / (kBytesPerSample[info.format] * info.channels);
+            return nullptr;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    return "no data chunk";
+}
+
+/**
+   Canonical 44 byte header; integer formats above 16 bits are written as plain PCM, which every
+   reader we know of accepts.
+ */
+static void writeWavHeader(uint8_t* const p, const SampleFormat format, const uint32_t sampleRate, const size_t frames)
+{
+    const uint32_t bytes = kBytesPerSample[format];
+    const uint32_t dataSize = (uint32_t)(frames * 2 * bytes);
+
+    std::memcpy(p, "RIFF", 4);
+    writeLE32(p + 4, 36 + dataSize);
+    std::memcpy(p + 8, "WAVEfmt ", 8);
+    writeLE32(p + 16, 16);
+    writeLE16(p + 20, format >= kFormatFloat32 ? 3 : 1);
+    writeLE16(p + 22, 2);
+    writeLE32(p + 24, sampleRate);
+    writeLE32(p + 28, sampleRate * 2 * bytes);
+    writeLE16(p + 32, 2 * bytes);
+    writeLE16(p + 34, 8 * bytes);
+    std::memcpy(p + 36, "data", 4);
+    writeLE32(p + 40, dataSize);
+}
+
+static const size_t kWavHeaderSize = 44;
+
+// --------------------------------------------------------------------------------------------------------------------
+// Sample conversion, one block between the interleaved file data and the engine's planar buffers
+
+static float decodeSample(const uint8_t* const p, const SampleFormat format) noexcept
+{
+    switch (format)
+    {
+    case kFormatInt16:
+        return (float)(int16_t)readLE16(p) * (1.0f / 32768.0f);
+    case kFormatInt24:
+        return (float)((int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8) * (1.0f / 8388608.0f);
+    case kFormatInt32:
+        return (float)((double)(int32_t)readLE32(p) * (1.0 / 2147483648.0));
+    case kFormatFloat32:
+    {
+        float v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    case kFormatFloat64:
+    {
+        double v;
+        std::memcpy(&v, p, sizeof(v));
+        return (float)v;
+    }
+    }
+    return 0.0f;
+}
+
+static void encodeSample(uint8_t* const p, const SampleFormat format, const float v) noexcept
+{
+    const double c = std::max(-1.0, std::min(1.0, (double)v));
+
+    switch (format)
+    {
+    case kFormatInt16:
+        writeLE16(p, (uint32_t)(int32_t)std::lrint(c * 32767.0));
+        break;
+    case kFormatInt24:
+    {
+        const uint32_t s = (uint32_t)(int32_t)std::lrint(c * 8388607.0);
+        p[0] = (uint8_t)s; p[1] = (uint8_t)(s >> 8); p[2] = (uint8_t)(s >> 16);
+        break;
+    }
+    case kFormatInt32:
+        writeLE32(p, (uint32_t)(int32_t)std::lrint(c * 2147483647.0));
+        break;
+    case kFormatFloat32:
+        std::memcpy(p, &v, sizeof(v));
+        break;
+    case kFormatFloat64:
+    {
+        const double d = v;
+        std::memcpy(p, &d, sizeof(d));
+        break;
+    }
+    }
+}
+
+static void decodeBlock(const WavInfo& in, const size_t frame, const uint32_t frames, float* const left, float* const right)
+{
+    const uint32_t stride = kBytesPerSample[in.format] * in.channels;
+    const uint32_t available = frame < in.frames ? (uint32_t)std::min<size_t>(frames, in.frames - frame) : 0;
+    const uint8_t* p = in.samples + frame * stride;
+
+    for (uint32_t t = 0; t < available; ++t, p += stride)
+    {
+        left[t] = decodeSample(p, in.format);
+        right[t] = in.channels == 2 ? decodeSample(p + kBytesPerSample[in.format], in.format) : left[t];
+    }
+
+    // the tail
+    std::fill(left + available, left + frames, 0.0f);
+    std::fill(right + available, right + frames, 0.0f);
+}
+
+static void encodeBlock(uint8_t* p, const SampleFormat format, const uint32_t frames, const float* const left, const float* const right)
+{
+    const uint32_t bytes = kBytesPerSample[format];
+
+    for (uint32_t t = 0; t < frames; ++t, p += 2 * bytes)
+    {
+        encodeSample(p, format, left[t]);
+        encodeSample(p + bytes, format, right[t]);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   One deque of task indices per worker. A worker pops from the back of its own deque and, once that
+   is empty, steals from the front of the others, so a few long files do not leave the other cores idle.
+   Tasks are whole files, a mutex per deque costs nothing next to rendering one.
+ */
+class WorkStealingQueue
+{
+public:
+    explicit WorkStealingQueue(const uint32_t numWorkers)
+        : fDeques(numWorkers) {}
+
+    void push(const uint32_t worker, const size_t task)
+    {
+        Deque& deque(fDeques[worker]);
+        const std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.push_back(task);
+    }
+
+    bool pop(const uint32_t worker, size_t& task)
+    {
+        const uint32_t numWorkers = (uint32_t)fDeques.size();
+
+        for (uint32_t i = 0; i < numWorkers; ++i)
+        {
+            const uint32_t victim = (worker + i) % numWorkers;
+            Deque& deque(fDeques[victim]);
+            const std::lock_guard<std::mutex> lock(deque.mutex);
+
+            if (deque.tasks.empty())
+                continue;
+
+            if (victim == worker)
+            {
+                task = deque.tasks.back();
+                deque.tasks.pop_back();
+            }
+            else
+            {
+                task = deque.tasks.front();
+                deque.tasks.pop_front();
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    struct Deque {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<Deque> fDeques;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static std::mutex gOutputMutex;
+
+static void flushDenormals()
+{
+#if defined(__SSE__) || defined(__x86_64__)
+    // flush to zero and denormals are zero
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ __volatile__("msr fpcr, %0" :: "r"(fpcr | (1u << 24)));
+#endif
+}
+
+static std::string outputPath(const std::string& input, const std::string& directory)
+{
+    const size_t slash = input.find_last_of('/');
+    std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+
+    const size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot != 0)
+        name.erase(dot);
+
+    name += "_dl3y.wav";
+
+    if (! directory.empty())
+        return directory + "/" + name;
+
+    return slash == std::string::npos ? name : input.substr(0, slash + 1) + name;
+}
+
+/**
+   Render one file, returns nullptr or the reason it failed.
+ */
+static const char* renderFile(DL3YEngine& engine, const RenderSettings& settings,
+                              const std::string& input, const std::string& output, double& seconds)
+{
+    MappedFile inFile;
+    if (! inFile.openRead(input))
+        return "cannot open input";
+
+    WavInfo in = WavInfo();
+    if (const char* const error = parseWav(inFile.data(), inFile.size(), in))
+        return error;
+
+    const SampleFormat outFormat = settings.floatOutput ? kFormatFloat32 : in.format;
+    const size_t frames = in.frames + (size_t)std::ceil(settings.tailSeconds * in.sampleRate);
+    const size_t outSize = kWavHeaderSize + frames * 2 * kBytesPerSample[outFormat];
+
+    if (outSize - kWavHeaderSize > 0xffffffffu - 36)
+        return "output larger than 4 GB";
+
+    MappedFile outFile;
+    if (! outFile.create(output, outSize))
+        return "cannot create output";
+
+    writeWavHeader(outFile.data(), outFormat, in.sampleRate, frames);
+
+    // parameters first, so the new lines and the first block start settled on them
+    for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+        engine.setParameter(p, settings.parameters[p]);
+    engine.setBpm(settings.bpm);
+    engine.setSampleRate(in.sampleRate);
+
+    float inL[kRenderBlock], inR[kRenderBlock], outL[kRenderBlock], outR[kRenderBlock];
+    const float* const ins[2] = { inL, inR };
+    float* const outs[2] = { outL, outR };
+    uint8_t* out = outFile.data() + kWavHeaderSize;
+
+    for (size_t frame = 0; frame < frames; frame += kRenderBlock)
+    {
+        const uint32_t n = (uint32_t)std::min<size_t>(kRenderBlock, frames - frame);
+
+        decodeBlock(in, frame, n, inL, inR);
+        engine.process(ins, outs, n);
+        encodeBlock(out, outFormat, n, outL, outR);
+
+        out += (size_t)n * 2 * kBytesPerSample[outFormat];
+    }
+
+    seconds = (double)frames / in.sampleRate;
+    return nullptr;
+}
+
+static void worker(const uint32_t index, WorkStealingQueue& queue, const std::vector<std::string>& files,
+                   const RenderSettings& settings, std::atomic<uint32_t>& done, std::atomic<uint32_t>& failed)
+{
+    flushDenormals();
+
+    DL3YEngine* engine = nullptr;
+    size_t task;
+
+    while (queue.pop(index, task))
+    {
+        const std::string& input(files[task]);
+        const std::string output(outputPath(input, settings.outputDirectory));
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        const char* error = nullptr;
+        double seconds = 0.0;
+
+        if (output == input)
+            error = "output would overwrite the input";
+        else
+        {
+            if (engine == nullptr)
+                engine = new DL3YEngine(48000.0);
+
+            error = renderFile(*engine, settings, input, output, seconds);
+        }
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const uint32_t count = ++done;
+
+        const std::lock_guard<std::mutex> lock(gOutputMutex);
+
+        if (error != nullptr)
+        {
+            ++failed;
+            std::fprintf(stderr, "[%u/%zu] %s: %s\n", count, files.size(), input.c_str(), error);
+        }
+        else
+        {
+            std::printf("[%u/%zu] %s -> %s (%.1f s, %.0fx realtime)\n", count, files.size(),
+                        input.c_str(), output.c_str(), seconds, seconds / std::max(elapsed, 1e-9));
+            std::fflush(stdout);
+        }
+    }
+
+    delete engine;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static int usage(const char* const program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-p Name=value]... [-b bpm] [-t seconds] [-o directory] [-j threads] [-f] file.wav...\n"
+                 "parameters:", program);
+
+    for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+        std::fprintf(stderr, " %s", kDL3YParameterRanges[p].receiver);
+
+    std::fprintf(stderr, "\n");
+    return 1;
+}
+
+static bool setParameter(RenderSettings& settings, const char* const assignment)
+{
+    const char* const equals = std::strchr(assignment, '=');
+    if (equals == nullptr)
+        return false;
+
+    const std::string name(assignment, equals);
+    char* end;
+    const float value = std::strtof(equals + 1, &end);
+
+    if (end == equals + 1 || *end != '\0')
+        return false;
+
+    for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+    {
+        if (name == kDL3YParameterRanges[p].receiver)
+        {
+            const DL3YParameterRange& range(kDL3YParameterRanges[p]);
+            settings.parameters[p] = std::max(range.min, std::min(range.max, value));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    RenderSettings settings;
+    for (uint32_t p = 0; p < kDL3YParameterCount; ++p)
+        settings.parameters[p] = kDL3YParameterRanges[p].def;
+    settings.bpm = kDL3YDefaultBpm;
+    settings.tailSeconds = 0.0;
+    settings.floatOutput = false;
+
+    uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "-p") == 0 && hasValue)
+        {
+            if (! setParameter(settings, argv[++i]))
+            {
+                std::fprintf(stderr, "invalid parameter: %s\n", argv[i]);
+                return usage(argv[0]);
+            }
+        }
+        else if (std::strcmp(arg, "-b") == 0 && hasValue)
+            settings.bpm = (float)std::atof(argv[++i]);
+        else if (std::strcmp(arg, "-t") == 0 && hasValue)
+            settings.tailSeconds = std::max(0.0, std::atof(argv[++i]));
+        else if (std::strcmp(arg, "-o") == 0 && hasValue)
+            settings.outputDirectory = argv[++i];
+        else if (std::strcmp(arg, "-j") == 0 && hasValue)
+            numThreads = (uint32_t)std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "-f") == 0)
+            settings.floatOutput = true;
+        else if (arg[0] == '-')
+            return usage(argv[0]);
+        else
+            files.push_back(arg);
+    }
+
+    if (files.empty() || settings.bpm <= 0.0f)
+        return usage(argv[0]);
+
+    if (! settings.outputDirectory.empty())
+        mkdir(settings.outputDirectory.c_str(), 0755);
+
+    // largest files first, dealt round robin, so the long ones start early and stealing evens out the rest
+    std::vector<std::pair<off_t, size_t> > order;
+    for (size_t f = 0; f < files.size(); ++f)
+    {
+        struct stat st;
+        order.push_back(std::make_pair(stat(files[f].c_str(), &st) == 0 ? st.st_size : 0, f));
+    }
+    std::stable_sort(order.begin(), order.end(), [](const std::pair<off_t, size_t>& a, const std::pair<off_t, size_t>& b) {
+        return a.first > b.first;
+    });
+
+    numThreads = std::min(numThreads, (uint32_t)files.size());
+    WorkStealingQueue queue(numThreads);
+
+    // each worker pops from the back of its deque, so push its share smallest first
+    for (size_t i = order.size(); i-- > 0;)
+        queue.push((uint32_t)(i % numThreads), order[i].second);
+
+    std::atomic<uint32_t> done(0), failed(0);
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 0; t < numThreads; ++t)
+        threads.push_back(std::thread(worker, t, std::ref(queue), std::cref(files), std::cref(settings),
+                                      std::ref(done), std::ref(failed)));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    if (failed != 0)
+    {
+        std::fprintf(stderr, "%u of %zu files failed\n", (unsigned)failed, files.size());
+        return 1;
+    }
+
+    return 0;
+}
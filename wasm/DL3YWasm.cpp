@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   WebAssembly exports of DL3YEngine for the browser demo and the Node benchmark.
+
+   Every instance owns four fixed buffers in linear memory: input left / right and output left / right
+   of up to kDL3YWasmMaxFrames frames. JavaScript creates Float32Array views on them once and reads and
+   writes audio there directly, dl3y_process() runs the engine on them in place. The only copies left
+   are the AudioWorklet's own render quantum into and out of the views, Web Audio hands those arrays
+   over outside of linear memory; nothing is allocated or converted per block.
+
+   Built twice by `make wasm`: scalar, and with -msimd128 so the engine's kernels vectorize to SIMD128.
+ */
+
+// WebAssembly has no flush to zero mode, the engine flushes its recursive state itself
+#ifndef DL3Y_FLUSH_DENORMALS
+# define DL3Y_FLUSH_DENORMALS 1
+#endif
+
+#include "DL3YEngine.hpp"
+
+#include <new>
+
+#ifdef __EMSCRIPTEN__
+# include <emscripten.h>
+# define DL3Y_WASM_EXPORT extern "C" EMSCRIPTEN_KEEPALIVE
+#else
+# define DL3Y_WASM_EXPORT extern "C"
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+// a few AudioWorklet render quanta (128 frames), larger blocks are processed in parts by the caller
+static const uint32_t kDL3YWasmMaxFrames = 1024;
+
+enum DL3YWasmBuffer {
+    kDL3YWasmInputLeft,
+    kDL3YWasmInputRight,
+    kDL3YWasmOutputLeft,
+    kDL3YWasmOutputRight,
+    kDL3YWasmBufferCount
+};
+
+struct DL3YWasm {
+    explicit DL3YWasm(const double sampleRate)
+        : engine(sampleRate) {}
+
+    DL3YEngine engine;
+    float buffers[kDL3YWasmBufferCount][kDL3YWasmMaxFrames];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+DL3Y_WASM_EXPORT DL3YWasm* dl3y_new(const double sampleRate)
+{
+    DL3YWasm* const dl3y = new (std::nothrow) DL3YWasm(sampleRate);
+
+    if (dl3y != nullptr)
+        std::memset(dl3y->buffers, 0, sizeof(dl3y->buffers));
+
+    return dl3y;
+}
+
+DL3Y_WASM_EXPORT void dl3y_delete(DL3YWasm* const dl3y)
+{
+    delete dl3y;
+}
+
+DL3Y_WASM_EXPORT uint32_t dl3y_max_frames()
+{
+    return kDL3YWasmMaxFrames;
+}
+
+DL3Y_WASM_EXPORT uint32_t dl3y_parameter_count()
+{
+    return kDL3YParameterCount;
+}
+
+/**
+   Address of one of the instance's audio buffers, see DL3YWasmBuffer.
+ */
+DL3Y_WASM_EXPORT float* dl3y_buffer(DL3YWasm* const dl3y, const uint32_t index)
+{
+    return index < kDL3YWasmBufferCount ? dl3y->buffers[index] : nullptr;
+}
+
+DL3Y_WASM_EXPORT void dl3y_set_parameter(DL3YWasm* const dl3y, const uint32_t index, const float value)
+{
+    dl3y->engine.setParameter(index, value);
+}
+
+DL3Y_WASM_EXPORT float dl3y_get_parameter(DL3YWasm* const dl3y, const uint32_t index)
+{
+    return dl3y->engine.getParameter(index);
+}
+
+DL3Y_WASM_EXPORT void dl3y_set_bpm(DL3YWasm* const dl3y, const float bpm)
+{
+    dl3y->engine.setBpm(bpm);
+}
+
+DL3Y_WASM_EXPORT void dl3y_reset(DL3YWasm* const dl3y)
+{
+    dl3y->engine.reset();
+}
+
+/**
+   Process frames from the input buffers into the output buffers.
+ */
+DL3Y_WASM_EXPORT void dl3y_process(DL3YWasm* const dl3y, const uint32_t frames)
+{
+    const float* const inputs[2] = { dl3y->buffers[kDL3YWasmInputLeft], dl3y->buffers[kDL3YWasmInputRight] };
+    float* const outputs[2] = { dl3y->buffers[kDL3YWasmOutputLeft], dl3y->buffers[kDL3YWasmOutputRight] };
+
+    dl3y->engine.process(inputs, outputs, frames < kDL3YWasmMaxFrames ? frames : kDL3YWasmMaxFrames);
+}
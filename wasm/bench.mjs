@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Headless Node benchmark of the scalar and SIMD128 WebAssembly builds of DL3YEngine.
+
+   Drives both modules the same way the AudioWorklet does (views on the instance buffers in linear
+   memory, one set() in and out per block) and reports ns/sample, realtime factor and the SIMD speedup
+   per block size, plus the largest output difference between the two builds. A last run feeds one
+   burst followed by silence, where the decaying tails would turn into denormals without the engine's
+   own flushing (WebAssembly has no flush to zero mode), and reports its speed and any denormal output.
+
+   Run with `make wasm-bench`, or `node wasm/bench.mjs [seconds] [directory with the .wasm files]`.
+ */
+
+import { readFile } from "node:fs/promises";
+import { join } from "node:path";
+
+const kSampleRate = 48000;
+const kBlockSizes = [32, 128, 512];
+
+// kDL3YBandParameters[b].time in dsp/DL3YParameters.hpp
+const kBandTimeParameters = [5, 20, 12];
+
+const seconds = Number(process.argv[2] || 10);
+const directory = process.argv[3] || join(import.meta.dirname ?? new URL(".", import.meta.url).pathname, "build");
+
+if (!(seconds > 0)) {
+    console.error("usage: node bench.mjs [seconds] [directory]");
+    process.exit(1);
+}
+
+function stubImports(module) {
+    const imports = {};
+
+    for (const entry of WebAssembly.Module.imports(module)) {
+        if (entry.kind !== "function")
+            continue;
+        imports[entry.module] = imports[entry.module] || {};
+        imports[entry.module][entry.name] = () => 0;
+    }
+
+    return imports;
+}
+
+async function load(file) {
+    const module = await WebAssembly.compile(await readFile(join(directory, file)));
+    const dsp = new WebAssembly.Instance(module, stubImports(module)).exports;
+
+    if (dsp._initialize)
+        dsp._initialize();
+
+    return dsp;
+}
+
+// noise bursts with a decaying envelope, as in bench/WSTD_DL3Y_bench.cpp
+function makeInput(frames) {
+    const left = new Float32Array(frames);
+    const right = new Float32Array(frames);
+    const burstLength = Math.floor(kSampleRate * 0.25);
+    let seed = 0x9e3779b9;
+    let env = 0;
+
+    const next = () => {
+        seed ^= seed << 13; seed >>>= 0;
+        seed ^= seed >>> 17;
+        seed ^= seed << 5; seed >>>= 0;
+        return (seed & 0xffff) / 32768 - 1;
+    };
+
+    for (let i = 0; i < frames; ++i) {
+        if (i % burstLength === 0)
+            env = 0.5;
+        env *= 0.9997;
+
+        const l = next();
+        const r = next();
+        left[i] = env * l;
+        right[i] = env * (0.5 * l + 0.5 * r);
+    }
+
+    return [left, right];
+}
+
+// the first burst of makeInput() followed by silence
+function makeSilence(frames) {
+    const input = makeInput(frames);
+    const burstLength = Math.floor(kSampleRate * 0.25);
+
+    input[0].fill(0, burstLength);
+    input[1].fill(0, burstLength);
+
+    return input;
+}
+
+const kMinNormal = 1.1754944e-38;
+
+// output frames with a denormal sample, and the last frame with a nonzero one
+function tailStats(output) {
+    let denormals = 0;
+    let lastNonzero = -1;
+
+    for (let i = 0; i < output[0].length; ++i) {
+        const l = Math.abs(output[0][i]);
+        const r = Math.abs(output[1][i]);
+
+        if ((l !== 0 && l < kMinNormal) || (r !== 0 && r < kMinNormal))
+            ++denormals;
+        if (l !== 0 || r !== 0)
+            lastNonzero = i;
+    }
+
+    return { denormals, lastNonzero };
+}
+
+function run(dsp, input, blockSize) {
+    const handle = dsp.dl3y_new(kSampleRate);
+    const frames = input[0].length;
+    const output = [new Float32Array(frames), new Float32Array(frames)];
+
+    for (let b = 0; b < kBandTimeParameters.length; ++b)
+        dsp.dl3y_set_parameter(handle, kBandTimeParameters[b], 200 + 100 * b);
+
+    const views = [0, 1, 2, 3].map(
+        (index) => new Float32Array(dsp.memory.buffer, dsp.dl3y_buffer(handle, index), blockSize));
+
+    const start = process.hrtime.bigint();
+
+    for (let offset = 0; offset + blockSize <= frames; offset += blockSize) {
+        views[0].set(input[0].subarray(offset, offset + blockSize));
+        views[1].set(input[1].subarray(offset, offset + blockSize));
+        dsp.dl3y_process(handle, blockSize);
+        output[0].set(views[2], offset);
+        output[1].set(views[3], offset);
+    }
+
+    const ns = Number(process.hrtime.bigint() - start);
+    dsp.dl3y_delete(handle);
+
+    return { ns: ns / frames, output };
+}
+
+const scalar = await load("dl3y_scalar.wasm");
+const simd = await load("dl3y_simd.wasm");
+const maxFrames = Math.min(scalar.dl3y_max_frames(), simd.dl3y_max_frames());
+const input = makeInput(Math.floor(seconds * kSampleRate));
+
+console.log(`DL3YEngine WebAssembly benchmark, ${seconds} s of stereo audio at ${kSampleRate} Hz per run`);
+console.log("block    scalar ns/sample   simd ns/sample   realtime   speedup   max diff");
+
+for (const blockSize of kBlockSizes) {
+    if (blockSize > maxFrames)
+        continue;
+
+    const a = run(scalar, input, blockSize);
+    const b = run(simd, input, blockSize);
+
+    let maxDiff = 0;
+    for (let c = 0; c < 2; ++c)
+        for (let i = 0; i < a.output[c].length; ++i)
+            maxDiff = Math.max(maxDiff, Math.abs(a.output[c][i] - b.output[c][i]));
+
+    console.log(
+        `${String(blockSize).padStart(5)} ${a.ns.toFixed(2).padStart(18)} ${b.ns.toFixed(2).padStart(16)}` +
+        ` ${(1e9 / kSampleRate / b.ns).toFixed(1).padStart(9)}x ${(a.ns / b.ns).toFixed(2).padStart(8)}x` +
+        ` ${maxDiff.toExponential(2).padStart(10)}`);
+}
+
+{
+    const blockSize = Math.min(128, maxFrames);
+    const silence = makeSilence(input[0].length);
+    const a = run(scalar, silence, blockSize);
+    const b = run(simd, silence, blockSize);
+
+    console.log("");
+    console.log("silence  scalar ns/sample   simd ns/sample   denormal frames   zero after");
+
+    const stats = [tailStats(a.output), tailStats(b.output)];
+    const zeroAfter = Math.max(stats[0].lastNonzero, stats[1].lastNonzero) + 1;
+
+    console.log(
+        `${String(blockSize).padStart(5)} ${a.ns.toFixed(2).padStart(18)} ${b.ns.toFixed(2).padStart(16)}` +
+        ` ${String(stats[0].denormals + stats[1].denormals).padStart(17)}` +
+        ` ${(zeroAfter / kSampleRate).toFixed(2).padStart(10)} s`);
+}
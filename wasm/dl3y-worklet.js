@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   AudioWorklet processor running the DL3YEngine WebAssembly build.
+
+   The compiled module arrives in processorOptions and is instantiated synchronously. Float32Array
+   views on the instance's four audio buffers in linear memory are created once (and again only if
+   the memory grows), so each render quantum is one set() into the input views, dl3y_process() and
+   one set() out of the output views: no allocation, no per-sample loop, no messages on the audio path.
+
+   Parameters and tempo arrive on the port as { type: "parameter", index, value } / { type: "bpm", value }.
+ */
+
+const kInputLeft = 0;
+const kInputRight = 1;
+const kOutputLeft = 2;
+const kOutputRight = 3;
+
+// the module is built standalone, its few libc imports are never called on the audio path
+function stubImports(module) {
+    const imports = {};
+
+    for (const entry of WebAssembly.Module.imports(module)) {
+        if (entry.kind !== "function")
+            continue;
+        imports[entry.module] = imports[entry.module] || {};
+        imports[entry.module][entry.name] = () => 0;
+    }
+
+    return imports;
+}
+
+class DL3YProcessor extends AudioWorkletProcessor {
+    constructor(options) {
+        super();
+
+        const { module, parameters } = options.processorOptions;
+
+        this.instance = new WebAssembly.Instance(module, stubImports(module));
+        this.dsp = this.instance.exports;
+
+        if (this.dsp._initialize)
+            this.dsp._initialize();
+
+        this.handle = this.dsp.dl3y_new(sampleRate);
+        this.maxFrames = this.dsp.dl3y_max_frames();
+        this.memory = null;
+        this.viewFrames = 0;
+        this.views = null;
+
+        for (const [index, value] of parameters || [])
+            this.dsp.dl3y_set_parameter(this.handle, index, value);
+
+        this.port.onmessage = (event) => {
+            const message = event.data;
+
+            switch (message.type) {
+            case "parameter":
+                this.dsp.dl3y_set_parameter(this.handle, message.index, message.value);
+                break;
+            case "bpm":
+                this.dsp.dl3y_set_bpm(this.handle, message.value);
+                break;
+            case "reset":
+                this.dsp.dl3y_reset(this.handle);
+                break;
+            }
+        };
+    }
+
+    // views of exactly frames length, so whole render quanta need no subarray()
+    getViews(frames) {
+        const buffer = this.dsp.memory.buffer;
+
+        if (buffer !== this.memory || frames !== this.viewFrames) {
+            this.memory = buffer;
+            this.viewFrames = frames;
+            this.views = [kInputLeft, kInputRight, kOutputLeft, kOutputRight].map(
+                (index) => new Float32Array(buffer, this.dsp.dl3y_buffer(this.handle, index), frames));
+        }
+
+        return this.views;
+    }
+
+    process(inputs, outputs) {
+        const input = inputs[0];
+        const output = outputs[0];
+        const frames = output[0].length;
+
+        for (let offset = 0; offset < frames; offset += this.maxFrames) {
+            const n = Math.min(frames - offset, this.maxFrames);
+            const views = this.getViews(n);
+
+            if (input.length === 0) {
+                views[kInputLeft].fill(0);
+                views[kInputRight].fill(0);
+            } else {
+                // mono sources are fed to both channels
+                const left = input[0];
+                const right = input.length > 1 ? input[1] : input[0];
+
+                if (n === frames) {
+                    views[kInputLeft].set(left);
+                    views[kInputRight].set(right);
+                } else {
+                    views[kInputLeft].set(left.subarray(offset, offset + n));
+                    views[kInputRight].set(right.subarray(offset, offset + n));
+                }
+            }
+
+            this.dsp.dl3y_process(this.handle, n);
+
+            output[0].set(views[kOutputLeft], offset);
+            if (output.length > 1)
+                output[1].set(views[kOutputRight], offset);
+        }
+
+        return true;
+    }
+}
+
+registerProcessor("wstd-dl3y", DL3YProcessor);
@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Browser loader for the DL3YEngine WebAssembly build.
+
+   Picks the SIMD128 module when the browser validates SIMD code and the scalar one otherwise,
+   compiles it once on the main thread and hands the compiled module to the AudioWorklet processor.
+
+       import { createDL3YNode } from "./dl3y.js";
+       const node = await createDL3YNode(context);
+       source.connect(node).connect(context.destination);
+       node.setParameter(kMidFreq, 880);
+ */
+
+// smallest module using a SIMD128 instruction (i8x16.popcnt), only valid where SIMD is supported
+const kSimdProbe = new Uint8Array([
+    0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+]);
+
+export function supportsSimd() {
+    return WebAssembly.validate(kSimdProbe);
+}
+
+export async function createDL3YNode(context, { baseUrl = new URL(".", import.meta.url), simd = supportsSimd(), parameters = [] } = {}) {
+    const file = simd ? "dl3y_simd.wasm" : "dl3y_scalar.wasm";
+    const module = await WebAssembly.compileStreaming(fetch(new URL(file, baseUrl)));
+
+    await context.audioWorklet.addModule(new URL("dl3y-worklet.js", baseUrl));
+
+    const node = new AudioWorkletNode(context, "wstd-dl3y", {
+        numberOfInputs: 1,
+        numberOfOutputs: 1,
+        outputChannelCount: [2],
+        processorOptions: { module, parameters },
+    });
+
+    node.simd = simd;
+    node.setParameter = (index, value) => node.port.postMessage({ type: "parameter", index, value });
+    node.setBpm = (value) => node.port.postMessage({ type: "bpm", value });
+    node.reset = () => node.port.postMessage({ type: "reset" });
+
+    return node;
+}